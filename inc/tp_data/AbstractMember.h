@@ -2,6 +2,7 @@
 
 #include "tp_data/Globals.h" // IWYU pragma: keep
 
+#include <atomic>
 #include <memory>
 
 namespace tp_data
@@ -27,6 +28,10 @@ public:
   //################################################################################################
   virtual ~AbstractMember();
 
+  //################################################################################################
+  //! Copy the name, type, timestamp and cached type index of another member.
+  AbstractMember(const AbstractMember& other);
+
   //################################################################################################
   //! The name of this member.
   /*!
@@ -59,10 +64,40 @@ public:
   //! set the timestamp of this member.
   void setTimestampMS(int64_t timestampMS);
 
+  //################################################################################################
+  //! The number of bytes of memory used by this member.
+  /*!
+  This is the size of the object plus the heap memory that it owns, subclasses should reimplement
+  this to add the memory used by their data. StringIDs are counted as the size of the handle as the
+  strings that they refer to are shared. Heap allocator overhead is not included.
+  */
+  virtual size_t memoryUsage() const;
+
+  //################################################################################################
+  //! Returned by typeIndex() when the index has not been set.
+  static constexpr size_t noTypeIndex = size_t(-1);
+
+  //################################################################################################
+  //! The index of the factory for this member in a finalized CollectionFactory.
+  /*!
+  This is a cache used by CollectionFactory to find the factory for a member without a hash lookup,
+  it is validated before use so it is safe to use a member with more than one CollectionFactory.
+  \returns The cached type index or noTypeIndex.
+  */
+  size_t typeIndex() const;
+
+  //################################################################################################
+  //! Set the cached type index, this is a cache so it can be set on const members.
+  /*!
+  The index is atomic so that threads saving the same shared member can set it concurrently.
+  */
+  void setTypeIndex(size_t typeIndex) const;
+
 private:
   tp_utils::StringID m_name;
   const tp_utils::StringID m_type;
   int64_t m_timestampMS;
+  mutable std::atomic<size_t> m_typeIndex{noTypeIndex};
 };
 
 //##################################################################################################
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "tp_data/AbstractMember.h"
+#include "tp_data/SharedBuffer.h"
 
 #include "tp_utils/TPPixel.h"
 
 #include "json.hpp" // IWYU pragma: keep
 
+#include <string_view>
+#include <type_traits>
+
 namespace tp_data
 {
 
@@ -16,6 +20,7 @@ This should be subclassed to save different AbstractMember types.
 */
 class AbstractMemberFactory
 {
+  friend class CollectionFactory;
 public:
   //################################################################################################
   //! Pass in the type of AbstractMember that this factory works with.
@@ -48,6 +53,13 @@ public:
   //! Color used for rendering node graphs.
   TPPixel color() const;
 
+  //################################################################################################
+  //! The index of this factory in its CollectionFactory, set by CollectionFactory::finalize().
+  /*!
+  \returns The index or AbstractMember::noTypeIndex if the CollectionFactory is not finalized.
+  */
+  size_t typeIndex() const;
+
   //################################################################################################
   //! Make a clone of the member.
   /*!
@@ -73,20 +85,147 @@ public:
   //################################################################################################
   virtual std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const=0;
 
+  //################################################################################################
+  //! Save the member by appending it to data.
+  /*!
+  This is used by CollectionFactory to write members straight into the output blob, so a save loop
+  that reuses its buffer does not need to allocate. Subclasses should reimplement this to append
+  directly, the default implementation calls save() with a temporary and appends it.
+
+  \param error This will be set on error.
+  \param member The member to save.
+  \param data The data will be appended to this, existing contents are left in place.
+  */
+  virtual void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const;
+
+  //################################################################################################
+  //! Load the member from a view of some data.
+  /*!
+  This allows members to be loaded from part of a larger buffer without first copying it into a
+  string. Subclasses should reimplement this to parse the view directly, the default implementation
+  copies it into a string and calls load().
+
+  \param error This will be set on error.
+  \param data The data to load, the member must not keep a reference to it.
+  \return The new member or nullptr.
+  */
+  virtual std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const;
+
+  //################################################################################################
+  //! Load a member from a shared buffer.
+  /*!
+  Subclasses can reimplement this to keep a reference to the buffer rather than copying the data
+  out of it, this is what allows large members to be loaded from a memory mapped file without a
+  copy. The default implementation calls loadView().
+
+  \param error This will be set on error.
+  \param data The data to load, this may be a slice of a larger buffer.
+  \return The new member or nullptr.
+  */
+  virtual std::shared_ptr<AbstractMember> loadShared(std::string& error, const SharedBuffer& data) const;
+
+  //################################################################################################
+  //! True if loadShared() references the buffer rather than copying it.
+  /*!
+  CollectionFactory uses this to decide if it is worth memory mapping member files.
+  */
+  virtual bool sharesLoadedData() const;
+
+  //################################################################################################
+  //! The alignment in bytes that the saved data should have within a blob.
+  /*!
+  When saving to a blob CollectionFactory will pad the blob so that the data of the member starts
+  at a multiple of this relative to the start of the blob. If the blob is then loaded from an
+  aligned buffer or a memory mapped file the data will be aligned in memory.
+  */
+  virtual size_t dataAlignment() const;
+
+  //################################################################################################
+  //! Save several members of this factories type in one call.
+  /*!
+  CollectionFactory calls this with all the members of a collection that use this factory, if
+  batchesMembers() returns true. Subclasses can reimplement this to avoid the per member overhead of
+  saveAppend(), the default implementation calls saveAppend() for each member.
+
+  \param error This will be set on error.
+  \param members The members to save, these will all be of this factories type.
+  \param data The members will be appended to this one after the other.
+  \param ends For each member the end offset of its data in data will be appended to this.
+  */
+  virtual void saveBatch(std::string& error,
+                         const std::vector<const AbstractMember*>& members,
+                         std::string& data,
+                         std::vector<size_t>& ends) const;
+
+  //################################################################################################
+  //! Load several members of this factories type in one call.
+  /*!
+  The default implementation calls loadView() for each member.
+
+  \param error This will be set on error.
+  \param data The data of each member to load.
+  \param members The new members will be appended to this, in the same order as data.
+  */
+  virtual void loadBatch(std::string& error,
+                         const std::vector<std::string_view>& data,
+                         std::vector<std::shared_ptr<AbstractMember>>& members) const;
+
+  //################################################################################################
+  //! True if saveBatch() and loadBatch() are faster than handling members one at a time.
+  /*!
+  CollectionFactory only groups members by type for factories that return true, this is intended
+  for small members such as numbers where the per member overhead dominates. The saved format is
+  the same either way.
+  */
+  virtual bool batchesMembers() const;
+
 private:
   const tp_utils::StringID m_type;
   std::string m_extension;
   TPPixel m_color;
+  size_t m_typeIndex{AbstractMember::noTypeIndex};
 };
 
+//##################################################################################################
+//! How JSONMemberFactoryTemplate saves members.
+enum class JSONEncoding
+{
+  Text,       //!< Plain JSON text, human readable.
+  CBOR,       //!< CBOR prefixed with the CBOR self-describe tag.
+  MessagePack //!< MessagePack prefixed with a 0xC1 byte, which MessagePack never uses.
+};
+
+//##################################################################################################
+//! The file extension used for an encoding.
+const std::string& jsonEncodingExtension(JSONEncoding encoding);
+
+//##################################################################################################
+//! Encode JSON and append it to data.
+void encodeJSON(const nlohmann::json& j, JSONEncoding encoding, std::string& data);
+
+//##################################################################################################
+//! Decode JSON that was saved with any of the encodings.
+/*!
+The encoding is detected from the data: CBOR starts with the self-describe tag, MessagePack starts
+with a 0xC1 byte, and anything else is parsed as JSON text.
+
+\throws nlohmann::json::exception if the data can't be parsed.
+*/
+nlohmann::json decodeJSON(std::string_view data);
+
 //##################################################################################################
 template<typename T, const tp_utils::StringID&(*type_)()>
 class JSONMemberFactoryTemplate : public AbstractMemberFactory
 {
 public:
   //################################################################################################
-  JSONMemberFactoryTemplate(TPPixel color):
-    AbstractMemberFactory(type_(), "json", color)
+  /*!
+  \param color Color used for rendering node graphs.
+  \param encoding The encoding used to save members, all encodings can always be loaded.
+  */
+  JSONMemberFactoryTemplate(TPPixel color, JSONEncoding encoding=JSONEncoding::Text):
+    AbstractMemberFactory(type_(), jsonEncodingExtension(encoding), color),
+    m_encoding(encoding)
   {
 
   }
@@ -106,6 +245,19 @@ public:
 
   //################################################################################################
   void save(std::string& error, const AbstractMember& member, std::string& data) const override
+  {
+    data.clear();
+    saveAppend(error, member, data);
+  }
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override
+  {
+    return loadView(error, data);
+  }
+
+  //################################################################################################
+  void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const override
   {
     auto m = dynamic_cast<const T*>(&member);
     if(!m)
@@ -114,15 +266,15 @@ public:
       return;
     }
 
-    data = m->toJSON().dump();
+    encodeJSON(m->toJSON(), m_encoding, data);
   }
 
   //################################################################################################
-  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override
+  std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const override
   {
     try
     {
-      auto j = nlohmann::json::parse(data);
+      auto j = decodeJSON(data);
       return std::shared_ptr<tp_data::AbstractMember>(T::fromJSON(j));
     }
     catch(...)
@@ -131,9 +283,37 @@ public:
       return {};
     }
   }
+
+private:
+  JSONEncoding m_encoding;
 };
 
+namespace detail
+{
+//##################################################################################################
+template<typename T, typename = void>
+struct HasAppendData : std::false_type {};
+
+template<typename T>
+struct HasAppendData<T, std::void_t<decltype(std::declval<const T&>().appendData(std::declval<std::string&>()))>> : std::true_type {};
+
+//##################################################################################################
+template<typename T, typename = void>
+struct HasViewFromData : std::false_type {};
+
+template<typename T>
+struct HasViewFromData<T, std::void_t<decltype(T::fromData(std::declval<std::string&>(), std::declval<std::string_view>()))>> : std::true_type {};
+}
+
 //##################################################################################################
+//! A factory for members that provide static fromData() and toData() methods.
+/*!
+Members can also provide these to avoid temporary strings, they will be used if present:
+\code
+void appendData(std::string& data) const;
+static T* fromData(std::string& error, std::string_view data);
+\endcode
+*/
 template<typename T, const tp_utils::StringID&(*type_)()>
 class MultiDataMemberFactoryTemplate : public AbstractMemberFactory
 {
@@ -162,6 +342,19 @@ public:
 
   //################################################################################################
   void save(std::string& error, const AbstractMember& member, std::string& data) const override
+  {
+    data.clear();
+    saveAppend(error, member, data);
+  }
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override
+  {
+    return loadView(error, data);
+  }
+
+  //################################################################################################
+  void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const override
   {
     auto m = dynamic_cast<const T*>(&member);
     if(!m)
@@ -170,13 +363,19 @@ public:
       return;
     }
 
-    data = m->toData();
+    if constexpr(detail::HasAppendData<T>::value)
+      m->appendData(data);
+    else
+      data += m->toData();
   }
 
   //################################################################################################
-  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override
+  std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const override
   {
-    return std::shared_ptr<AbstractMember>(T::fromData(error, data));
+    if constexpr(detail::HasViewFromData<T>::value)
+      return std::shared_ptr<AbstractMember>(T::fromData(error, data));
+    else
+      return std::shared_ptr<AbstractMember>(T::fromData(error, std::string(data)));
   }
 };
 
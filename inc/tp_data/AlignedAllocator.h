@@ -0,0 +1,73 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <new>
+#include <vector>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! An allocator that aligns allocations to Alignment bytes.
+/*!
+This is used for storage that is handed to SIMD kernels or written directly to disk, 64 bytes
+covers the widest vector registers and a typical cache line.
+*/
+template<typename T, size_t Alignment=64>
+class AlignedAllocator
+{
+public:
+  using value_type = T;
+
+  //################################################################################################
+  template<typename U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  //################################################################################################
+  AlignedAllocator() noexcept = default;
+
+  //################################################################################################
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+  {
+
+  }
+
+  //################################################################################################
+  T* allocate(size_t n)
+  {
+    return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  //################################################################################################
+  void deallocate(T* p, size_t n) noexcept
+  {
+    TP_UNUSED(n);
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  //################################################################################################
+  template<typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return true;
+  }
+
+  //################################################################################################
+  template<typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return false;
+  }
+};
+
+//##################################################################################################
+//! A std::vector with 64 byte aligned storage.
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <string_view>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Create a binary delta that turns base into target.
+/*!
+The delta is a sequence of copy operations that reference ranges of base and insert operations
+that hold new bytes. Matches are found by indexing base in blocks with a rolling hash so the cost
+is linear in the size of the inputs. This works well for payloads that are mostly unchanged or that
+have had bytes inserted or removed, it does not compress the inserted bytes.
+
+\param base The data that the receiver already has.
+\param target The data that the receiver should end up with.
+\param delta The delta will be appended to this.
+*/
+TP_DATA_SHARED_EXPORT void makeBinaryDelta(std::string_view base, std::string_view target, std::string& delta);
+
+//##################################################################################################
+//! Apply a delta created by makeBinaryDelta().
+/*!
+\param error If the delta is malformed or does not match base this will be set.
+\param base The same data that was passed to makeBinaryDelta().
+\param delta The delta.
+\param output The result will be appended to this.
+\return True on success.
+*/
+TP_DATA_SHARED_EXPORT bool applyBinaryDelta(std::string& error,
+                                            std::string_view base,
+                                            std::string_view delta,
+                                            std::string& output);
+
+}
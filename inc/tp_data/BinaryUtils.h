@@ -0,0 +1,91 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <cstring>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! True if the host stores numbers little endian, the byte order used by the binary codecs.
+constexpr bool hostIsLittleEndian()
+{
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  return false;
+#else
+  return true;
+#endif
+}
+
+//##################################################################################################
+//! Reverse the bytes of each of the count values pointed to by data.
+template<typename T>
+void byteSwapInPlace(T* data, size_t count)
+{
+  auto bytes = reinterpret_cast<uint8_t*>(data);
+  for(size_t i=0; i<count; i++, bytes+=sizeof(T))
+    for(size_t a=0, b=sizeof(T)-1; a<b; a++, b--)
+      std::swap(bytes[a], bytes[b]);
+}
+
+//##################################################################################################
+//! Append count values to output as little endian bytes.
+template<typename T>
+void appendLittleEndian(std::string& output, const T* data, size_t count)
+{
+  size_t offset = output.size();
+  output.resize(offset + count*sizeof(T));
+  if(count==0)
+    return;
+
+  std::memcpy(&output[offset], data, count*sizeof(T));
+  if(!hostIsLittleEndian())
+    byteSwapInPlace(reinterpret_cast<T*>(&output[offset]), count);
+}
+
+//##################################################################################################
+//! Copy count little endian values from input into output.
+template<typename T>
+void readLittleEndian(const char* input, T* output, size_t count)
+{
+  if(count==0)
+    return;
+
+  std::memcpy(output, input, count*sizeof(T));
+  if(!hostIsLittleEndian())
+    byteSwapInPlace(output, count);
+}
+
+//##################################################################################################
+//! Append an unsigned LEB128 variable length integer, small values take fewer bytes.
+inline void appendVarint(std::string& output, uint64_t value)
+{
+  while(value>=0x80)
+  {
+    output.push_back(char(uint8_t(value) | 0x80));
+    value >>= 7;
+  }
+  output.push_back(char(value));
+}
+
+//##################################################################################################
+//! Read a variable length integer written by appendVarint and advance p.
+/*!
+\return False if the input ends before the integer or the integer is too long.
+*/
+inline bool readVarint(const char*& p, const char* end, uint64_t& value)
+{
+  value = 0;
+  for(int shift=0; shift<64 && p<end; shift+=7)
+  {
+    auto byte = uint8_t(*p);
+    p++;
+    value |= uint64_t(byte & 0x7F) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <string_view>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Reading and writing the parts that make up the output of CollectionFactory::saveToData().
+/*!
+A blob is a sequence of parts, each part is a 1 byte key length, the key, a 4 byte little endian
+data length, and the data. A collection starts with "name" and "timestamp" parts and then each
+member is a "member" part followed by "type", "timestamp", optional "pad", and "data" parts.
+Readers skip parts with keys that they do not know.
+*/
+namespace blob
+{
+
+//##################################################################################################
+inline void addPart(std::string& output, std::string_view key, std::string_view data)
+{
+  auto keyLen = uint8_t(key.size());
+  auto partLen = keyLen + data.size() + 5;
+
+  output.reserve(output.size()+partLen);
+  output.push_back(static_cast<char>(keyLen));
+  output.append(key);
+
+  output.push_back(static_cast<char>(data.size() >>  0));
+  output.push_back(static_cast<char>(data.size() >>  8));
+  output.push_back(static_cast<char>(data.size() >> 16));
+  output.push_back(static_cast<char>(data.size() >> 24));
+
+  output.append(data);
+}
+
+//##################################################################################################
+//! Write the header of a part with a placeholder length, returns the offset of the length.
+inline size_t beginPart(std::string& output, std::string_view key)
+{
+  output.push_back(static_cast<char>(uint8_t(key.size())));
+  output.append(key);
+  size_t lengthOffset = output.size();
+  output.append(4, '\0');
+  return lengthOffset;
+}
+
+//##################################################################################################
+//! Fill in the length of a part started with beginPart, once its data has been appended.
+inline bool endPart(std::string& error, std::string& output, size_t lengthOffset)
+{
+  size_t len = output.size() - (lengthOffset+4);
+  if(len > 0xFFFFFFFFu)
+  {
+    error = "Member data exceeds the 4GB part size limit.";
+    return false;
+  }
+
+  output[lengthOffset+0] = static_cast<char>(len >>  0);
+  output[lengthOffset+1] = static_cast<char>(len >>  8);
+  output[lengthOffset+2] = static_cast<char>(len >> 16);
+  output[lengthOffset+3] = static_cast<char>(len >> 24);
+  return true;
+}
+
+//##################################################################################################
+//! Add padding so that the payload of the next "data" part starts on a multiple of alignment.
+inline void addAlignmentPart(std::string& output, size_t alignment)
+{
+  if(alignment<2)
+    return;
+
+  //The pad part is 8 bytes + padding and the data part header is 9 bytes.
+  size_t padLen = (alignment - ((output.size()+17) % alignment)) % alignment;
+  addPart(output, "pad", std::string(padLen, '\0'));
+}
+
+//##################################################################################################
+//! Parse a part without copying its data, the data is returned as an offset into input.
+inline bool parsePart(std::string& error,
+                      const char* input,
+                      size_t inputSize,
+                      size_t& startFrom,
+                      std::string& key,
+                      size_t& dataOffset,
+                      size_t& dataLen)
+{
+  auto ok = [inputSize, &startFrom, &error](size_t count)
+  {
+    bool ok = ((startFrom+count)<=inputSize);
+    if(!ok)
+      error = "Unexpectedly reached end of buffer.";
+    return ok;
+  };
+
+  //- Read a single unsigned byte that is the key length -------------------------------------------
+  if(inputSize<=startFrom)
+    return false;
+
+  auto keyLen = static_cast<uint8_t>(input[startFrom]);
+  startFrom++;
+
+
+  //- Read the key ---------------------------------------------------------------------------------
+  if(!ok(keyLen))
+    return false;
+
+  key.assign(input+startFrom, keyLen);
+  startFrom += keyLen;
+
+
+  //- Read a 4 byte unsigned little endian number that is the length of the data -------------------
+  if(!ok(4))
+    return false;
+
+  dataLen = 0;
+  for(size_t i=0; i<4; i++)
+  {
+    auto p = uint8_t(input[startFrom]);
+    startFrom++;
+    dataLen |= (size_t(p) << (8*i));
+  }
+
+
+  //- Read the data --------------------------------------------------------------------------------
+  if(!ok(dataLen))
+    return false;
+
+  dataOffset = startFrom;
+  startFrom += dataLen;
+
+  return true;
+}
+
+}
+
+}
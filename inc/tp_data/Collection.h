@@ -50,6 +50,14 @@ public:
   //! This takes ownership.
   void addMember(const std::shared_ptr<AbstractMember>& member);
 
+  //################################################################################################
+  //! Replace the member with the same name keeping its position, or add it if there is none.
+  void replaceMember(const std::shared_ptr<AbstractMember>& member);
+
+  //################################################################################################
+  //! Remove a member, returns false if there is no member with that name.
+  bool removeMember(const tp_utils::StringID& name);
+
   //################################################################################################
   const std::vector<std::shared_ptr<AbstractMember>>& members() const;
 
@@ -62,6 +70,14 @@ public:
   */
   const std::shared_ptr<AbstractMember>& member(const tp_utils::StringID& name) const;
 
+  //################################################################################################
+  //! The number of bytes of memory used by this collection and its members.
+  /*!
+  This adds up AbstractMember::memoryUsage() for each member plus the memory used by the collection
+  itself, including an estimate of the shared_ptr control block of each member.
+  */
+  size_t memoryUsage() const;
+
   //################################################################################################
   template<typename T>
   void memberCast(const tp_utils::StringID& name, T*& member_) const
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "tp_data/AlignedAllocator.h"
+
+#include <memory>
+
+namespace tp_data
+{
+class AbstractMember;
+class Collection;
+class CollectionFactory;
+
+//##################################################################################################
+//! A column of values gathered from the same member of many collections.
+struct TP_DATA_SHARED_EXPORT BatchColumn
+{
+  tp_utils::StringID name;          //!< The name of the member that this column holds.
+  tp_utils::StringID type;          //!< The type of the member that this column holds.
+  size_t elementSize{0};            //!< The size in bytes of a single value.
+  AlignedVector<uint8_t> values;    //!< One value per collection, 64 byte aligned and zero padded.
+  std::vector<uint8_t> present;     //!< 1 if the collection had this member, else 0.
+};
+
+//##################################################################################################
+//! Holds the numeric members of many collections as struct-of-arrays columns.
+/*!
+When the same computation needs to be run over thousands of collections that share a schema it is
+much faster to scan a contiguous column than to call Collection::member() and dynamic_cast for each
+value. A CollectionBatch gathers the numeric members (IntMember, SizeTMember, FloatMember,
+DoubleMember, Int64Member, UInt64Member) of N collections into one column per member name. Each
+column is 64 byte aligned and padded with zeros to a multiple of 64 bytes so that SIMD kernels can
+process whole registers.
+
+Results can be written back to collections as members using scatter().
+
+\code
+tp_data::CollectionBatch batch;
+batch.gather(collections, {weightSID()});
+const float* weights = batch.values<tp_data::FloatMember>(weightSID());
+float* scaled = batch.addColumn<tp_data::FloatMember>(scaledSID());
+for(size_t i=0; i<batch.size(); i++)
+  scaled[i] = weights[i] * 2.0f;
+batch.scatter(error, scaledSID(), collections);
+\endcode
+
+\note Collections that do not have a member will have a 0 value in the column, use
+BatchColumn::present to tell the difference.
+*/
+class TP_DATA_SHARED_EXPORT CollectionBatch
+{
+  TP_NONCOPYABLE(CollectionBatch);
+  TP_DQ;
+public:
+  //################################################################################################
+  CollectionBatch();
+
+  //################################################################################################
+  ~CollectionBatch();
+
+  //################################################################################################
+  //! Gather columns from collections.
+  /*!
+  This will replace any existing columns.
+
+  \param collections The collections to gather from, one row per collection, nullptr is allowed.
+  \param names The members to gather, if empty all numeric members will be gathered.
+  */
+  void gather(const std::vector<const Collection*>& collections,
+              const std::vector<tp_utils::StringID>& names=std::vector<tp_utils::StringID>());
+
+  //################################################################################################
+  //! Load blobs of data directly into columns.
+  /*!
+  Each blob should be the output of CollectionFactory::saveToData, one row is created per blob.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param collectionFactory Used to decode the members.
+  \param data The blobs to load.
+  \param subset If this is not empty only a subset of members will be loaded.
+  */
+  void loadFromData(std::string& error,
+                    const CollectionFactory& collectionFactory,
+                    const std::vector<std::string>& data,
+                    const std::vector<std::string>& subset=std::vector<std::string>());
+
+  //################################################################################################
+  //! The number of rows (collections) in the batch.
+  size_t size() const;
+
+  //################################################################################################
+  //! Remove all columns and rows.
+  void clear();
+
+  //################################################################################################
+  //! The names of the columns in the order that they were added.
+  const std::vector<tp_utils::StringID>& columnNames() const;
+
+  //################################################################################################
+  //! Returns the column for name or nullptr.
+  const BatchColumn* column(const tp_utils::StringID& name) const;
+
+  //################################################################################################
+  //! Returns the column for name or nullptr.
+  BatchColumn* column(const tp_utils::StringID& name);
+
+  //################################################################################################
+  //! Add an empty (zero filled) column, if the column already exists it will be returned.
+  /*!
+  \param name The name of the column.
+  \param type The member type of the column, this must be one of the numeric member types.
+  \return The column or nullptr if the type is not supported or conflicts with an existing column.
+  */
+  BatchColumn* addColumn(const tp_utils::StringID& name, const tp_utils::StringID& type);
+
+  //################################################################################################
+  //! Returns the values of a column or nullptr if the column does not exist or has another type.
+  template<typename M>
+  const typename M::ValueType* values(const tp_utils::StringID& name) const
+  {
+    return reinterpret_cast<const typename M::ValueType*>(typedValues(name, M::memberType(), sizeof(typename M::ValueType)));
+  }
+
+  //################################################################################################
+  //! Returns the values of a column or nullptr if the column does not exist or has another type.
+  template<typename M>
+  typename M::ValueType* values(const tp_utils::StringID& name)
+  {
+    return reinterpret_cast<typename M::ValueType*>(const_cast<uint8_t*>(typedValues(name, M::memberType(), sizeof(typename M::ValueType))));
+  }
+
+  //################################################################################################
+  //! Add a column for member type M and return its values.
+  template<typename M>
+  typename M::ValueType* addColumn(const tp_utils::StringID& name)
+  {
+    if(!addColumn(name, M::memberType()))
+      return nullptr;
+    return values<M>(name);
+  }
+
+  //################################################################################################
+  //! Write a column back to collections as members.
+  /*!
+  Members that already exist will have their data replaced, missing members will be created.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param name The name of the column to write.
+  \param collections The collections to write to, this must have size() entries, nullptr is allowed.
+  */
+  void scatter(std::string& error,
+               const tp_utils::StringID& name,
+               const std::vector<Collection*>& collections) const;
+
+private:
+  //################################################################################################
+  const uint8_t* typedValues(const tp_utils::StringID& name,
+                             const tp_utils::StringID& type,
+                             size_t elementSize) const;
+};
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <functional>
+#include <memory>
+
+namespace tp_data
+{
+class Collection;
+class CollectionFactory;
+class SharedBuffer;
+
+//##################################################################################################
+//! Statistics for a CollectionCache.
+struct TP_DATA_SHARED_EXPORT CollectionCacheStats
+{
+  size_t hits{0};       //!< Requests that were served from the cache.
+  size_t misses{0};     //!< Requests that had to load the collection.
+  size_t coalesced{0};  //!< Requests that waited for another thread that was loading the same key.
+  size_t evictions{0};  //!< Collections removed to stay within the byte budget.
+  size_t entries{0};    //!< The number of collections currently in the cache.
+  size_t bytes{0};      //!< The memory used by the cached collections, see Collection::memoryUsage().
+};
+
+//##################################################################################################
+//! A thread safe cache of loaded collections bounded by a byte budget.
+/*!
+Collections are loaded through a CollectionFactory and handed out as shared read only collections,
+so the same loaded collection can be used by many threads at once. Each collection is identified by
+a key, this is the path for loadFromPath() and a caller supplied content id for loadFromData().
+
+When the memory used by the cached collections exceeds the byte budget the least recently used
+collections are evicted. Evicted collections remain valid for as long as something holds a
+reference to them. A collection that is larger than the whole budget is returned but not cached.
+
+Concurrent requests for a key that is not in the cache are coalesced, the first request loads the
+collection and the others wait for it. Loads that fail are not cached.
+
+\code
+tp_data::CollectionCache cache(&collectionFactory, 512*1024*1024);
+std::string error;
+auto collection = cache.loadFromPath(error, path);
+\endcode
+
+\note The keys of loadFromPath() and loadFromData() share a namespace.
+*/
+class TP_DATA_SHARED_EXPORT CollectionCache
+{
+  TP_NONCOPYABLE(CollectionCache);
+  TP_DQ;
+public:
+  //################################################################################################
+  //! Load function used by get(), it should populate the empty output collection.
+  using LoadFunction = std::function<void(std::string& error, Collection& output)>;
+
+  //################################################################################################
+  /*!
+  \param collectionFactory Used to load collections, this is not owned and must outlive the cache.
+  \param byteBudget The maximum memory that cached collections should use.
+  */
+  CollectionCache(const CollectionFactory* collectionFactory, size_t byteBudget);
+
+  //################################################################################################
+  ~CollectionCache();
+
+  //################################################################################################
+  //! Set the byte budget, this will evict collections if the cache is now over budget.
+  void setByteBudget(size_t byteBudget);
+
+  //################################################################################################
+  size_t byteBudget() const;
+
+  //################################################################################################
+  //! Load a collection from a directory or return the cached copy, the path is used as the key.
+  /*!
+  \param error If something goes wrong this will be set to a description of the error.
+  \param path A path to the directory to load from, see CollectionFactory::loadFromPath().
+  \return The collection or nullptr on error.
+  */
+  std::shared_ptr<const Collection> loadFromPath(std::string& error, const std::string& path);
+
+  //################################################################################################
+  //! Load a collection from a blob of data or return the cached copy.
+  /*!
+  \param error If something goes wrong this will be set to a description of the error.
+  \param key Identifies the content of the data, for example a hash or an object id.
+  \param data The data to load from, only used if the key is not already cached.
+  \return The collection or nullptr on error.
+  */
+  std::shared_ptr<const Collection> loadFromData(std::string& error,
+                                                 const std::string& key,
+                                                 const std::string& data);
+
+  //################################################################################################
+  //! Load a collection from a shared buffer or return the cached copy.
+  std::shared_ptr<const Collection> loadFromData(std::string& error,
+                                                 const std::string& key,
+                                                 const SharedBuffer& data);
+
+  //################################################################################################
+  //! Return the cached collection for key or call load to load it.
+  /*!
+  This is used to implement the other load methods and can be used to cache collections that are
+  loaded from other sources. The load function is called without any locks held, if it throws the
+  exception is caught and reported through error to this caller and to any callers waiting on it.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param key Identifies the collection.
+  \param load Called to load the collection if it is not in the cache.
+  \return The collection or nullptr on error.
+  */
+  std::shared_ptr<const Collection> get(std::string& error, const std::string& key, const LoadFunction& load);
+
+  //################################################################################################
+  //! Return the cached collection for key without loading it, or nullptr.
+  std::shared_ptr<const Collection> find(const std::string& key) const;
+
+  //################################################################################################
+  //! Remove a collection from the cache, for example when the file it was loaded from changes.
+  /*!
+  If the key is currently being loaded the waiting requests still get the result but it will not be
+  added to the cache.
+  */
+  void remove(const std::string& key);
+
+  //################################################################################################
+  //! Remove all collections from the cache.
+  void clear();
+
+  //################################################################################################
+  CollectionCacheStats stats() const;
+};
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include "json.hpp" // IWYU pragma: keep
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! The differences between two collections, see CollectionFactory::diff().
+struct TP_DATA_SHARED_EXPORT CollectionDiff
+{
+  std::vector<tp_utils::StringID> added;   //!< Members in b that are not in a, in b order.
+  std::vector<tp_utils::StringID> removed; //!< Members in a that are not in b, in a order.
+  std::vector<tp_utils::StringID> changed; //!< Members in both with a different type or content.
+
+  //################################################################################################
+  //! Returns true if the collections have the same members with the same content.
+  bool empty() const;
+
+  //################################################################################################
+  nlohmann::json toJSON() const;
+};
+
+}
@@ -1,7 +1,8 @@
 #pragma once
 
-#include "tp_data/Globals.h"
+#include "tp_data/Executor.h"
 
+#include <future>
 #include <memory>
 
 namespace tp_data
@@ -9,6 +10,33 @@ namespace tp_data
 class AbstractMember;
 class AbstractMemberFactory;
 class Collection;
+struct CollectionDiff;
+struct CollectionInfo;
+class FactoryCounters;
+class LoadFilter;
+class SharedBuffer;
+
+//##################################################################################################
+//! The result of an asynchronous save to path.
+struct TP_DATA_SHARED_EXPORT AsyncResult
+{
+  std::string error;     //!< Empty on success.
+  bool cancelled{false}; //!< True if the operation was cancelled, error will also be set.
+};
+
+//##################################################################################################
+//! The result of an asynchronous load.
+struct TP_DATA_SHARED_EXPORT AsyncLoadResult : public AsyncResult
+{
+  std::shared_ptr<Collection> collection; //!< The loaded collection or nullptr on error.
+};
+
+//##################################################################################################
+//! The result of an asynchronous save to data.
+struct TP_DATA_SHARED_EXPORT AsyncSaveDataResult : public AsyncResult
+{
+  std::string data; //!< The saved data.
+};
 
 //##################################################################################################
 //! Used to load / save Collection objects.
@@ -17,6 +45,9 @@ This is used to load and save Collection objects, it works by delegating work to
 AbstractMemberFactory objects. The addMemberFactory can be used to add factories for all of the
 member types that the collection is expected to hold.
 
+The load and save methods also have asynchronous variants that run on an executor, see
+setExecutor(). These either return a future or call a callback on the executor thread when done.
+
 \note This class is thread safe provided that addMemberFactory is only called at construction.
 */
 class CollectionFactory
@@ -33,6 +64,12 @@ public:
   bool finalized() const;
 
   //################################################################################################
+  //! Prevent further factories from being added.
+  /*!
+  This also builds a dense table of the factories and gives each a type index. Loaded members are
+  tagged with the type index of their factory so that subsequent lookups are an array access
+  rather than a hash lookup, see memberFactory(const AbstractMember&).
+  */
   void finalize();
 
   //################################################################################################
@@ -47,9 +84,36 @@ public:
   //! Returns the member factory for type or nullptr.
   const AbstractMemberFactory* memberFactory(const tp_utils::StringID& type) const;
 
+  //################################################################################################
+  //! Returns the member factory for a member or nullptr.
+  /*!
+  Once finalized this uses the type index cached on the member, if the member does not have a valid
+  index the factory is looked up by type and the index is cached on the member.
+  */
+  const AbstractMemberFactory* memberFactory(const AbstractMember& member) const;
+
+  //################################################################################################
+  //! Returns the member factory for a type name or nullptr, this avoids constructing a StringID.
+  const AbstractMemberFactory* memberFactoryByName(const std::string& type) const;
+
+  //################################################################################################
+  //! Returns the member factory for a type index or nullptr, only valid once finalized.
+  const AbstractMemberFactory* memberFactoryByIndex(size_t typeIndex) const;
+
   //################################################################################################
   const std::unordered_map<tp_utils::StringID, std::unique_ptr<AbstractMemberFactory>>& memberFactories() const;
 
+  //################################################################################################
+  //! Per member type performance counters, these are disabled by default.
+  /*!
+  Once enabled the calls this class makes to its member factories are timed and counted, use
+  FactoryCounters::snapshot() to read them.
+  */
+  FactoryCounters& counters();
+
+  //################################################################################################
+  const FactoryCounters& counters() const;
+
   //################################################################################################
   //! Clones a collection and adds it to the output.
   /*!
@@ -81,10 +145,53 @@ public:
                     Collection& output,
                     const std::vector<std::string>& subset=std::vector<std::string>()) const;
 
+  //################################################################################################
+  //! Load the members of a blob of data that pass a filter.
+  /*!
+  The filter is evaluated using the name, type, and timestamp of each member before its data is
+  decoded.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param data The data to load from.
+  \param output An empty Collection that the data will be loaded into.
+  \param filter Selects the members to load.
+  */
+  void loadFromData(std::string& error,
+                    const std::string& data,
+                    Collection& output,
+                    const LoadFilter& filter) const;
+
+  //################################################################################################
+  //! Load a Collection from a shared buffer.
+  /*!
+  This is the same as the std::string version except that factories that support it can reference
+  the buffer rather than copying their data out of it. Combined with SharedBuffer::mapFile() this
+  allows large members to be loaded from disk without a copy.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param data The data to load from.
+  \param output An empty Collection that the data will be loaded into.
+  \param subset If this is not empty only a subset of members will be loaded.
+  */
+  void loadFromData(std::string& error,
+                    const SharedBuffer& data,
+                    Collection& output,
+                    const std::vector<std::string>& subset=std::vector<std::string>()) const;
+
+  //################################################################################################
+  //! Load the members of a shared buffer that pass a filter.
+  void loadFromData(std::string& error,
+                    const SharedBuffer& data,
+                    Collection& output,
+                    const LoadFilter& filter) const;
+
   //################################################################################################
   //! Load a Collection from a directory.
   /*!
-  This loads the Collection from a directory containing a file for each member.
+  This loads the Collection from a directory containing a file for each member. Member files for
+  factories that share loaded data (see AbstractMemberFactory::sharesLoadedData()) are memory mapped.
+  saveToPath() replaces member files by renaming a new file over them so mapped files are never
+  modified, other tools must not rewrite the member files of a loaded collection in place.
 
   \param error If something goes wrong this will be set to a description of the error.
   \param path A path to the directory to load from.
@@ -96,15 +203,78 @@ public:
                     Collection& output,
                     const std::vector<std::string>& subset=std::vector<std::string>()) const;
 
+  //################################################################################################
+  //! Load the members of a directory that pass a filter.
+  /*!
+  The filter is evaluated using the index so the files of members that are rejected are not read.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param path A path to the directory to load from.
+  \param output An empty Collection that the data will be loaded into.
+  \param filter Selects the members to load.
+  */
+  void loadFromPath(std::string& error,
+                    const std::string& path,
+                    Collection& output,
+                    const LoadFilter& filter) const;
+
+  //################################################################################################
+  //! List the members of a blob of data without loading them.
+  /*!
+  This parses the member headers only, no member data is copied and no member factory is called.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param data The data to list, the output of saveToData().
+  \param output This will be cleared and then populated with the details of the collection.
+  */
+  void listFromData(std::string& error, const std::string& data, CollectionInfo& output) const;
+
+  //################################################################################################
+  //! List the members of a shared buffer without loading them.
+  void listFromData(std::string& error, const SharedBuffer& data, CollectionInfo& output) const;
+
+  //################################################################################################
+  //! List the members of a directory without loading them.
+  /*!
+  This reads the index file only. The encoded size of each member is read from the index, for
+  directories saved before sizes were recorded the size of each member file is queried.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param path A path to the directory, the output of saveToPath().
+  \param output This will be cleared and then populated with the details of the collection.
+  */
+  void listFromPath(std::string& error, const std::string& path, CollectionInfo& output) const;
+
   //################################################################################################
   //! Save a Collection to a blob of data.
   /*!
+  If a member factory requests an alignment (see AbstractMemberFactory::dataAlignment()) padding
+  is inserted so that the data of that member is aligned relative to the start of the blob.
+
   \param error If something goes wrong this will be set to a description of the error.
   \param collection The Collection to save.
   \param data The output data.
   */
   void saveToData(std::string& error, const Collection& collection, std::string& data) const;
 
+  //################################################################################################
+  //! Save members that are not held in a Collection to a blob of data.
+  /*!
+  The output is the same as saving a Collection with this name, timestamp, and members. This is
+  used by TypedCollection to save members that it holds by value.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param name The name of the collection.
+  \param timestampMS The timestamp of the collection.
+  \param members The members to save, in order.
+  \param data The output data.
+  */
+  void saveToData(std::string& error,
+                  const std::string& name,
+                  int64_t timestampMS,
+                  const std::vector<const AbstractMember*>& members,
+                  std::string& data) const;
+
   //################################################################################################
   //! Save a Collection to a directory.
   /*!
@@ -121,6 +291,113 @@ public:
                   const std::string& path,
                   bool append=false) const;
 
+  //################################################################################################
+  //! Save a Collection to a directory with member data in a content addressed object store.
+  /*!
+  This is the same as saveToPath() except that each serialized member is hashed with SHA-256 and
+  written once to objectStorePath/<first 2 hex digits>/<hash>.<extension>, the index refers to it by
+  hash. Members that are already in the store are not written again, so collections that share
+  large members only store them once. The store can be shared by many collections and is read by
+  loadFromPath().
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param collection The Collection to save.
+  \param path The path to the output directory, this will contain the index.
+  \param objectStorePath The object store directory, a relative path is relative to path. If this
+  is empty the member files are written to path as in saveToPath().
+  \param append Append the collection to the existing contents of the path.
+  */
+  void saveToObjectStore(std::string& error,
+                         const Collection& collection,
+                         const std::string& path,
+                         const std::string& objectStorePath,
+                         bool append=false) const;
+
+  //################################################################################################
+  //! Set the executor used to run asynchronous operations.
+  /*!
+  If this is not set a ThreadPoolExecutor is created the first time an asynchronous method is
+  called. Operations that are already queued will still run on the previous executor.
+  */
+  void setExecutor(const std::shared_ptr<AbstractExecutor>& executor);
+
+  //################################################################################################
+  std::shared_ptr<AbstractExecutor> executor() const;
+
+  //################################################################################################
+  //! Limit the number of asynchronous operations that can be in flight at once, 0 for no limit.
+  /*!
+  When the limit is reached further operations are queued and passed to the executor as running
+  operations complete, the asynchronous methods never block. An operation releases its slot after
+  its callback returns, so a callback that starts the next operation queues it.
+  */
+  void setMaxInFlight(size_t maxInFlight);
+
+  //################################################################################################
+  size_t maxInFlight() const;
+
+  //################################################################################################
+  //! Asynchronous version of loadFromPath().
+  /*!
+  \note This factory must outlive the operations that it starts, its destructor waits for them.
+  */
+  std::future<AsyncLoadResult> loadFromPathAsync(const std::string& path,
+                                                 const std::vector<std::string>& subset=std::vector<std::string>(),
+                                                 const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of loadFromPath(), the callback is called from the executor.
+  void loadFromPathAsync(const std::string& path,
+                         const std::function<void(AsyncLoadResult&&)>& callback,
+                         const std::vector<std::string>& subset=std::vector<std::string>(),
+                         const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of loadFromData(), the data is moved into the operation.
+  std::future<AsyncLoadResult> loadFromDataAsync(std::string data,
+                                                 const std::vector<std::string>& subset=std::vector<std::string>(),
+                                                 const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of loadFromData(), the callback is called from the executor.
+  void loadFromDataAsync(std::string data,
+                         const std::function<void(AsyncLoadResult&&)>& callback,
+                         const std::vector<std::string>& subset=std::vector<std::string>(),
+                         const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of saveToData().
+  /*!
+  The collection must not be modified until the operation completes.
+  */
+  std::future<AsyncSaveDataResult> saveToDataAsync(const std::shared_ptr<const Collection>& collection,
+                                                   const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of saveToData(), the callback is called from the executor.
+  void saveToDataAsync(const std::shared_ptr<const Collection>& collection,
+                       const std::function<void(AsyncSaveDataResult&&)>& callback,
+                       const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of saveToPath().
+  /*!
+  The collection must not be modified until the operation completes. Cancelling a save that has
+  started does not remove the files that it has written.
+  */
+  std::future<AsyncResult> saveToPathAsync(const std::shared_ptr<const Collection>& collection,
+                                           const std::string& path,
+                                           bool append=false,
+                                           const CancellationToken& cancellationToken=CancellationToken()) const;
+
+  //################################################################################################
+  //! Asynchronous version of saveToPath(), the callback is called from the executor.
+  void saveToPathAsync(const std::shared_ptr<const Collection>& collection,
+                       const std::string& path,
+                       const std::function<void(AsyncResult&&)>& callback,
+                       bool append=false,
+                       const CancellationToken& cancellationToken=CancellationToken()) const;
+
   //################################################################################################
   //! Return a clone of the member or nullptr on error.
   /*!
@@ -146,6 +423,60 @@ public:
                        const AbstractMember& member,
                        std::string& data,
                        std::string& extension) const;
+
+  //################################################################################################
+  //! Return a 64 bit hash of the serialized form of a member.
+  /*!
+  The member is serialized each time this is called so the hash always reflects its current data,
+  members are normally modified by writing to their data directly so a cached hash could not be
+  kept up to date. The name and timestamp of the member are not included in the hash.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param member The member to hash.
+  \return The hash, this is never 0.
+  */
+  uint64_t memberHash(std::string& error, const AbstractMember& member) const;
+
+  //################################################################################################
+  //! Find the members that have been added, removed, or changed between two collections.
+  /*!
+  Members are matched by name and compared by type and memberHash() so only the hashes of the
+  serialized members are compared. Timestamps are ignored.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param a The original collection.
+  \param b The new collection.
+  \param output The differences between a and b.
+  */
+  void diff(std::string& error, const Collection& a, const Collection& b, CollectionDiff& output) const;
+
+  //################################################################################################
+  //! Create a patch that turns collection a into collection b.
+  /*!
+  The patch holds only the members that were added, changed, or removed, see diff(). Members that
+  only changed their timestamp are sent without data. Large changed members of the same type are
+  sent as a binary delta of their serialized form if that is smaller, see makeBinaryDelta().
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param a The collection that the receiver already has.
+  \param b The collection that the receiver should end up with.
+  \param patch The output patch.
+  */
+  void savePatch(std::string& error, const Collection& a, const Collection& b, std::string& patch) const;
+
+  //################################################################################################
+  //! Apply a patch created by savePatch() to a collection in place.
+  /*!
+  The collection should have the same content as the collection a that the patch was created from,
+  deltas are checked against a hash of the member that they modify. The patch is decoded before
+  any change is made so on error the collection is left unchanged. Changed members keep their
+  position and added members are appended.
+
+  \param error If something goes wrong this will be set to a description of the error.
+  \param patch The patch to apply.
+  \param collection The collection to modify.
+  */
+  void applyPatch(std::string& error, const std::string& patch, Collection& collection) const;
 };
 
 }
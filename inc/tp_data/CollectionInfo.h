@@ -0,0 +1,39 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include "json.hpp" // IWYU pragma: keep
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Describes a saved member without loading it.
+struct TP_DATA_SHARED_EXPORT MemberInfo
+{
+  std::string name;       //!< The name of the member.
+  std::string type;       //!< The key string of the member type.
+  int64_t timestampMS{0}; //!< The timestamp of the member.
+  size_t encodedSize{0};  //!< The size in bytes of the saved member data.
+
+  //################################################################################################
+  nlohmann::json toJSON() const;
+};
+
+//##################################################################################################
+//! Describes a saved collection without loading it, see CollectionFactory::listFromData().
+struct TP_DATA_SHARED_EXPORT CollectionInfo
+{
+  std::string name;
+  int64_t timestampMS{0};
+  std::vector<MemberInfo> members;
+
+  //################################################################################################
+  //! The sum of the encoded size of the members.
+  size_t encodedSize() const;
+
+  //################################################################################################
+  nlohmann::json toJSON() const;
+};
+
+}
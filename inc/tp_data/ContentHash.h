@@ -0,0 +1,51 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <array>
+#include <string_view>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Fast 64 bit non-cryptographic hash, this is XXH64.
+/*!
+Input is consumed 32 bytes at a time by 4 independent lanes so the loop pipelines well and can be
+vectorized by the compiler. Use this to detect changes, use SHA256 where collisions must be avoided.
+*/
+TP_DATA_SHARED_EXPORT uint64_t hash64(std::string_view data, uint64_t seed=0);
+
+//##################################################################################################
+//! Incremental SHA-256, used to identify serialized members by their content.
+class TP_DATA_SHARED_EXPORT SHA256
+{
+public:
+  //################################################################################################
+  SHA256();
+
+  //################################################################################################
+  void add(std::string_view data);
+
+  //################################################################################################
+  //! Finish the hash and return the digest, add() must not be called after this.
+  std::array<uint8_t, 32> finish();
+
+  //################################################################################################
+  //! Finish the hash and return the digest as 64 lower case hex characters.
+  std::string finishHex();
+
+  //################################################################################################
+  //! Hash data in one call and return the digest as hex.
+  static std::string hex(std::string_view data);
+
+private:
+  void processBlock(const uint8_t* block);
+
+  std::array<uint32_t, 8> m_state;
+  std::array<uint8_t, 64> m_buffer;
+  size_t m_bufferSize{0};
+  uint64_t m_length{0};
+};
+
+}
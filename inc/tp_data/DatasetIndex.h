@@ -0,0 +1,232 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <limits>
+#include <type_traits>
+
+namespace tp_data
+{
+class AbstractMember;
+class Collection;
+class CollectionFactory;
+
+//##################################################################################################
+//! A number in a DatasetIndex, integers are held exactly rather than converted to double.
+/*!
+Numbers of different kinds are compared by value, so Int64 5, UInt64 5 and Double 5.0 are equal
+and 2^53+1 is greater than 2^53 even though they are the same as doubles.
+*/
+struct TP_DATA_SHARED_EXPORT DatasetNumber
+{
+  enum class Kind : uint8_t
+  {
+    Int64,
+    UInt64,
+    Double
+  };
+
+  Kind kind{Kind::Double};
+  int64_t int64{0};
+  uint64_t uint64{0};
+  double real{0.0};
+
+  //################################################################################################
+  template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+  DatasetNumber(T value)
+  {
+    if constexpr(std::is_floating_point_v<T>)
+    {
+      kind = Kind::Double;
+      real = double(value);
+    }
+    else if constexpr(std::is_signed_v<T>)
+    {
+      kind = Kind::Int64;
+      int64 = int64_t(value);
+    }
+    else
+    {
+      kind = Kind::UInt64;
+      uint64 = uint64_t(value);
+    }
+  }
+
+  //################################################################################################
+  //! NaN can't be ordered so it is never indexed and never matches.
+  bool isNaN() const;
+
+  //################################################################################################
+  //! Compare exactly by value, neither number may be NaN.
+  bool operator<(const DatasetNumber& other) const;
+};
+
+//##################################################################################################
+//! A query against a DatasetIndex, a collection matches if it matches every condition.
+/*!
+\code
+tp_data::DatasetQuery query;
+query.equals(labelSID(), "cat").greaterThan(countSID(), 5);
+\endcode
+*/
+class TP_DATA_SHARED_EXPORT DatasetQuery
+{
+public:
+  //################################################################################################
+  struct Condition
+  {
+    tp_utils::StringID name;
+
+    //! If true compare text, otherwise compare numbers.
+    bool isText{false};
+    std::string text;
+
+    DatasetNumber min{-std::numeric_limits<double>::infinity()};
+    DatasetNumber max{ std::numeric_limits<double>::infinity()};
+    bool minInclusive{true};
+    bool maxInclusive{true};
+  };
+
+  //################################################################################################
+  //! The member must be a string or string id equal to value.
+  DatasetQuery& equals(const tp_utils::StringID& name, const std::string& value);
+
+  //################################################################################################
+  //! The member must be a number equal to value.
+  DatasetQuery& equals(const tp_utils::StringID& name, const DatasetNumber& value);
+
+  //################################################################################################
+  DatasetQuery& greaterThan(const tp_utils::StringID& name, const DatasetNumber& value);
+
+  //################################################################################################
+  DatasetQuery& lessThan(const tp_utils::StringID& name, const DatasetNumber& value);
+
+  //################################################################################################
+  //! The member must be a number in the range [min, max].
+  DatasetQuery& between(const tp_utils::StringID& name, const DatasetNumber& min, const DatasetNumber& max);
+
+  //################################################################################################
+  const std::vector<Condition>& conditions() const;
+
+private:
+  std::vector<Condition> m_conditions;
+};
+
+//##################################################################################################
+//! An inverted index of member values across many saved collections.
+/*!
+The values of the indexed members of each collection are recorded against a key, normally the path
+that the collection was saved to. Queries are answered from the index alone so no collection needs
+to be loaded. String and string id members are indexed by value and numeric members are indexed in
+order so that range queries only visit matching values. Integer members are compared exactly, see
+DatasetNumber, and NaN values are not indexed.
+
+The index is held in memory and persisted to a file with a journal next to it. Each update is
+appended to the journal, compact() rewrites the file and empties the journal. Opening an index
+reads the file and then replays the journal, a partial entry at the end of the journal from an
+interrupted write is ignored.
+
+\code
+tp_data::DatasetIndex index(&collectionFactory);
+index.addIndexedMember(error, labelSID());
+index.addIndexedMember(error, countSID());
+index.open(error, datasetPath + "/dataset_index.json");
+
+index.saveToPath(error, collection, datasetPath + "/0001");
+
+tp_data::DatasetQuery query;
+query.equals(labelSID(), "cat").greaterThan(countSID(), 5);
+auto keys = index.query(error, query);
+\endcode
+
+\note Collections indexed before a member was added are only indexed on that member once they are
+updated again.
+*/
+class TP_DATA_SHARED_EXPORT DatasetIndex
+{
+  TP_NONCOPYABLE(DatasetIndex);
+  TP_DQ;
+public:
+  //################################################################################################
+  /*!
+  \param collectionFactory Used to save and load collections, this is not owned and must outlive
+  the index.
+  */
+  DatasetIndex(const CollectionFactory* collectionFactory);
+
+  //################################################################################################
+  ~DatasetIndex();
+
+  //################################################################################################
+  //! Index the values of members with this name, the list is saved with the index.
+  /*!
+  \param error Set if the index is open and the member could not be written to the journal.
+  \param name The name of the members to index.
+  \return True on success, on failure the member is not indexed.
+  */
+  bool addIndexedMember(std::string& error, const tp_utils::StringID& name);
+
+  //################################################################################################
+  const std::vector<tp_utils::StringID>& indexedMembers() const;
+
+  //################################################################################################
+  //! Load the index from a file and its journal, if the file does not exist an empty index is used.
+  /*!
+  Updates made after this are appended to the journal at indexPath + ".journal".
+
+  \param error If the index could not be read this will be set.
+  \param indexPath The path of the index file, normally inside the dataset directory.
+  \return True on success.
+  */
+  bool open(std::string& error, const std::string& indexPath);
+
+  //################################################################################################
+  //! Rewrite the index file with the current contents and empty the journal.
+  bool compact(std::string& error);
+
+  //################################################################################################
+  //! Replace the indexed values for key with the values of the collection.
+  bool update(std::string& error, const std::string& key, const Collection& collection);
+
+  //################################################################################################
+  //! Index the output of CollectionFactory::saveToData(), only the indexed members are decoded.
+  bool updateFromData(std::string& error, const std::string& key, const std::string& data);
+
+  //################################################################################################
+  //! Index the output of CollectionFactory::saveToPath(), the path is used as the key.
+  /*!
+  Only the indexed members are read, this can be used to index a dataset that already exists.
+  */
+  bool updateFromPath(std::string& error, const std::string& path);
+
+  //################################################################################################
+  //! Remove a collection from the index.
+  bool remove(std::string& error, const std::string& key);
+
+  //################################################################################################
+  //! Save a collection with CollectionFactory::saveToPath() and index it with the path as its key.
+  bool saveToPath(std::string& error, const Collection& collection, const std::string& path);
+
+  //################################################################################################
+  //! Save a collection with CollectionFactory::saveToData() and index it against key.
+  bool saveToData(std::string& error, const std::string& key, const Collection& collection, std::string& data);
+
+  //################################################################################################
+  //! Returns true if key is in the index.
+  bool contains(const std::string& key) const;
+
+  //################################################################################################
+  //! The number of collections in the index.
+  size_t size() const;
+
+  //################################################################################################
+  //! Find the keys of the collections that match every condition of the query, in sorted order.
+  /*!
+  \param error Set if the query uses a member that is not indexed.
+  \param query The conditions to match, an empty query returns every key.
+  \return The keys of the matching collections.
+  */
+  std::vector<std::string> query(std::string& error, const DatasetQuery& query) const;
+};
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Runs the tasks of the asynchronous CollectionFactory methods.
+class TP_DATA_SHARED_EXPORT AbstractExecutor
+{
+public:
+  //################################################################################################
+  virtual ~AbstractExecutor();
+
+  //################################################################################################
+  //! Run a task, this may be called from any thread.
+  virtual void execute(std::function<void()>&& task) = 0;
+};
+
+//##################################################################################################
+//! Runs tasks on a fixed pool of threads in the order that they are submitted.
+class TP_DATA_SHARED_EXPORT ThreadPoolExecutor : public AbstractExecutor
+{
+  TP_NONCOPYABLE(ThreadPoolExecutor);
+  TP_DQ;
+public:
+  //################################################################################################
+  /*!
+  \param threadCount The number of threads, 0 uses std::thread::hardware_concurrency().
+  */
+  ThreadPoolExecutor(size_t threadCount=0);
+
+  //################################################################################################
+  //! Waits for queued tasks to complete and then joins the threads.
+  ~ThreadPoolExecutor() override;
+
+  //################################################################################################
+  size_t threadCount() const;
+
+  //################################################################################################
+  void execute(std::function<void()>&& task) override;
+};
+
+//##################################################################################################
+//! Runs tasks immediately in the calling thread, useful for tests and single threaded tools.
+class TP_DATA_SHARED_EXPORT InlineExecutor : public AbstractExecutor
+{
+public:
+  //################################################################################################
+  void execute(std::function<void()>&& task) override;
+};
+
+//##################################################################################################
+//! Used to cancel asynchronous operations, copies share the same state.
+/*!
+Cancellation is checked before an operation starts and when it completes, an operation that is
+cancelled while running will finish its work but report that it was cancelled and discard its
+result.
+*/
+class TP_DATA_SHARED_EXPORT CancellationToken
+{
+public:
+  //################################################################################################
+  CancellationToken():
+    m_cancelled(std::make_shared<std::atomic<bool>>(false))
+  {
+
+  }
+
+  //################################################################################################
+  void cancel() const
+  {
+    m_cancelled->store(true, std::memory_order_relaxed);
+  }
+
+  //################################################################################################
+  bool cancelled() const
+  {
+    return m_cancelled->load(std::memory_order_relaxed);
+  }
+
+private:
+  std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include "json.hpp" // IWYU pragma: keep
+
+#include <chrono>
+#include <vector>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! The operations that are counted for each member type.
+enum class CountedOperation
+{
+  Save,  //!< Saving a member to data or to a file.
+  Load,  //!< Loading a member from data or from a file.
+  Clone  //!< Cloning a member.
+};
+
+//##################################################################################################
+//! Totals for one operation on one member type.
+struct TP_DATA_SHARED_EXPORT OperationCounters
+{
+  uint64_t calls{0};   //!< The number of members processed.
+  uint64_t errors{0};  //!< The number of calls that failed.
+  uint64_t bytes{0};   //!< Bytes encoded for saves or decoded for loads.
+  uint64_t totalNS{0}; //!< Cumulative time spent in the factory.
+  uint64_t maxNS{0};   //!< The longest single call, a batch of members counts as one call.
+
+  //################################################################################################
+  nlohmann::json toJSON() const;
+};
+
+//##################################################################################################
+//! The counters for one member type.
+struct TP_DATA_SHARED_EXPORT MemberTypeCounters
+{
+  tp_utils::StringID type;
+  OperationCounters save;
+  OperationCounters load;
+  OperationCounters clone;
+
+  //################################################################################################
+  nlohmann::json toJSON() const;
+};
+
+//##################################################################################################
+//! Per member type performance counters for a CollectionFactory.
+/*!
+Counting is disabled by default, when disabled the cost is a single relaxed atomic load per call.
+When enabled each thread updates its own block of counters so that threads never contend, the
+blocks are summed by snapshot(). The counters of a thread are kept after it exits.
+
+Counters are indexed by AbstractMemberFactory::typeIndex() so only members of a finalized
+CollectionFactory are counted.
+
+\code
+collectionFactory.counters().setEnabled(true);
+...
+tpWarning() << collectionFactory.counters().snapshotJSON().dump(2);
+\endcode
+*/
+class TP_DATA_SHARED_EXPORT FactoryCounters
+{
+  TP_NONCOPYABLE(FactoryCounters);
+  TP_DQ;
+public:
+  //################################################################################################
+  FactoryCounters();
+
+  //################################################################################################
+  ~FactoryCounters();
+
+  //################################################################################################
+  void setEnabled(bool enabled);
+
+  //################################################################################################
+  bool enabled() const;
+
+  //################################################################################################
+  //! Zero all counters.
+  void reset();
+
+  //################################################################################################
+  //! Set the member types in type index order, this is called by CollectionFactory::finalize().
+  void setTypes(const std::vector<tp_utils::StringID>& types);
+
+  //################################################################################################
+  //! Add to the counters of the calling thread.
+  void record(size_t typeIndex,
+              CountedOperation operation,
+              uint64_t calls,
+              uint64_t bytes,
+              uint64_t ns,
+              bool error) const;
+
+  //################################################################################################
+  //! Sum the counters of all threads.
+  std::vector<MemberTypeCounters> snapshot() const;
+
+  //################################################################################################
+  //! The snapshot as JSON, member types that have not been used are left out.
+  nlohmann::json snapshotJSON() const;
+};
+
+//##################################################################################################
+//! Times an operation and records it when stop() is called, does nothing if counting is disabled.
+class CountedScope
+{
+public:
+  //################################################################################################
+  CountedScope(const FactoryCounters& counters, size_t typeIndex, CountedOperation operation):
+    m_counters(counters),
+    m_typeIndex(typeIndex),
+    m_operation(operation),
+    m_enabled(counters.enabled())
+  {
+    if(m_enabled)
+      m_start = std::chrono::steady_clock::now();
+  }
+
+  //################################################################################################
+  void stop(uint64_t calls, uint64_t bytes, bool error)
+  {
+    if(!m_enabled)
+      return;
+
+    m_enabled = false;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-m_start).count();
+    m_counters.record(m_typeIndex, m_operation, calls, bytes, uint64_t(ns), error);
+  }
+
+private:
+  const FactoryCounters& m_counters;
+  size_t m_typeIndex;
+  CountedOperation m_operation;
+  bool m_enabled;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+}
@@ -20,7 +20,17 @@ TP_DECLARE_ID(                          intSID,                              "In
 TP_DECLARE_ID(                        sizeTSID,                           "Size t");
 TP_DECLARE_ID(                        floatSID,                            "Float");
 TP_DECLARE_ID(                       doubleSID,                           "Double");
+TP_DECLARE_ID(                        int64SID,                            "Int64");
+TP_DECLARE_ID(                       uint64SID,                           "UInt64");
 TP_DECLARE_ID(               stringIDVectorSID,                 "String id vector");
+TP_DECLARE_ID(                  floatVectorSID,                   "Float vector");
+TP_DECLARE_ID(                 doubleVectorSID,                  "Double vector");
+TP_DECLARE_ID(                  int32VectorSID,                   "Int32 vector");
+TP_DECLARE_ID(                  int64VectorSID,                   "Int64 vector");
+TP_DECLARE_ID(                  uint8VectorSID,                   "UInt8 vector");
+TP_DECLARE_ID(                       tensorSID,                         "Tensor");
+TP_DECLARE_ID(                        imageSID,                          "Image");
+TP_DECLARE_ID(                        bytesSID,                          "Bytes");
 
 //##################################################################################################
 //! Add the collection factories that this module provides to the CollectionFactory
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <limits>
+#include <unordered_set>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Selects which members to load from a saved collection.
+/*!
+The CollectionFactory load methods evaluate the filter using only the name, type, and timestamp of
+each member, so members that are rejected are never read from disk, copied, or decoded. A member
+is loaded if it passes all of the criteria that have been set, an empty filter loads everything.
+
+\code
+//Load all of the FloatMembers newer than t.
+tp_data::LoadFilter filter;
+filter.addType(tp_data::floatSID());
+filter.setTimestampRange(t, std::numeric_limits<int64_t>::max());
+collectionFactory.loadFromPath(error, path, output, filter);
+\endcode
+*/
+class TP_DATA_SHARED_EXPORT LoadFilter
+{
+public:
+  //################################################################################################
+  //! Construct a filter that accepts all members.
+  LoadFilter()=default;
+
+  //################################################################################################
+  //! Construct a filter that accepts members with the given names, an empty list accepts all.
+  LoadFilter(const std::vector<std::string>& names);
+
+  //################################################################################################
+  //! Accept members with this name, once a name is added only named members are loaded.
+  LoadFilter& addName(const std::string& name);
+
+  //################################################################################################
+  LoadFilter& addNames(const std::vector<std::string>& names);
+
+  //################################################################################################
+  //! Accept members of this type, once a type is added only members of these types are loaded.
+  LoadFilter& addType(const tp_utils::StringID& type);
+
+  //################################################################################################
+  //! Only accept members with minMS <= timestampMS <= maxMS.
+  LoadFilter& setTimestampRange(int64_t minMS, int64_t maxMS);
+
+  //################################################################################################
+  //! Returns true if this filter accepts every member.
+  bool acceptsAll() const;
+
+  //################################################################################################
+  bool acceptsName(const std::string& name) const;
+
+  //################################################################################################
+  //! Type is the key string of the type's StringID, as it is saved in collections.
+  bool acceptsType(const std::string& type) const;
+
+  //################################################################################################
+  bool acceptsTimestamp(int64_t timestampMS) const;
+
+  //################################################################################################
+  //! Returns true if the member should be loaded.
+  bool accepts(const std::string& name, const std::string& type, int64_t timestampMS) const;
+
+private:
+  std::unordered_set<std::string> m_names;
+  std::unordered_set<std::string> m_types;
+  int64_t m_minTimestampMS{std::numeric_limits<int64_t>::min()};
+  int64_t m_maxTimestampMS{std::numeric_limits<int64_t>::max()};
+};
+
+}
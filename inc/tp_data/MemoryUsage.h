@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! The heap memory owned by a string, short strings are stored inline and own no heap memory.
+inline size_t heapMemoryUsage(const std::string& value)
+{
+  static const size_t inlineCapacity = std::string().capacity();
+  return (value.capacity()>inlineCapacity)?(value.capacity()+1):0;
+}
+
+//##################################################################################################
+//! The heap memory owned by a vector of trivial values, this uses the capacity not the size.
+template<typename T, typename A>
+size_t heapMemoryUsage(const std::vector<T, A>& value)
+{
+  return value.capacity()*sizeof(T);
+}
+
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "tp_data/BlobFormat.h"
+#include "tp_data/Collection.h"
+#include "tp_data/members/NumberMember.h"
+#include "tp_data/members/StringIDMember.h"
+#include "tp_data/members/StringMember.h"
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+//##################################################################################################
+//! Declare the fields of a plain struct so that it can be saved with saveStructToData().
+/*!
+This must be placed at namespace scope in the same namespace as the struct so that it is found by
+argument dependent lookup. Each field is declared with TP_DATA_FIELD or TP_DATA_NAMED_FIELD.
+
+\code
+namespace my
+{
+struct Sample
+{
+  float weight{0.0f};
+  std::string label;
+};
+
+TP_DATA_REFLECT(Sample, TP_DATA_FIELD(weight), TP_DATA_NAMED_FIELD("Label", label))
+}
+\endcode
+*/
+#define TP_DATA_REFLECT(Struct, ...) \
+  [[maybe_unused]] inline auto tpDataReflectFields(const Struct*) \
+  { \
+    using TPDataReflectSelf = Struct; \
+    return std::make_tuple(__VA_ARGS__); \
+  }
+
+//! A field that is saved using its C++ name as the member name.
+#define TP_DATA_FIELD(field) tp_data::reflectField(#field, &TPDataReflectSelf::field)
+
+//! A field that is saved with a different member name, for example to match an existing TP_DECLARE_ID.
+#define TP_DATA_NAMED_FIELD(name, field) tp_data::reflectField(name, &TPDataReflectSelf::field)
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! How a field type is saved, this must match the member factory for the same type.
+/*!
+Specialize this to add support for other field types, each specialization provides the member
+class that the field becomes in a Collection and functions to append and parse the saved form. parse
+sets error if the saved form is invalid.
+*/
+template<typename T, typename Enable=void>
+struct ReflectType;
+
+//##################################################################################################
+template<typename M>
+struct ReflectNumberType
+{
+  using MemberType = M;
+
+  //################################################################################################
+  static const tp_utils::StringID& type()
+  {
+    return M::memberType();
+  }
+
+  //################################################################################################
+  static void append(std::string& output, typename M::ValueType value)
+  {
+    detail::appendNumber(output, value);
+  }
+
+  //################################################################################################
+  static void parse(std::string& error, std::string_view data, typename M::ValueType& value)
+  {
+    value = detail::parseNumber<typename M::ValueType>(error, data);
+  }
+};
+
+//##################################################################################################
+template<> struct ReflectType<int>     : ReflectNumberType<IntMember>{};
+template<> struct ReflectType<size_t>  : ReflectNumberType<SizeTMember>{};
+template<> struct ReflectType<float>   : ReflectNumberType<FloatMember>{};
+template<> struct ReflectType<double>  : ReflectNumberType<DoubleMember>{};
+template<> struct ReflectType<int64_t> : ReflectNumberType<Int64Member>{};
+
+//##################################################################################################
+//! uint64_t is only distinct from size_t on some platforms, for example it is unsigned long long
+//! on macOS where size_t is unsigned long.
+template<typename T>
+struct ReflectType<T, std::enable_if_t<std::is_same_v<T, uint64_t> && !std::is_same_v<uint64_t, size_t>>> :
+    ReflectNumberType<UInt64Member>{};
+
+//##################################################################################################
+template<>
+struct ReflectType<std::string>
+{
+  using MemberType = StringMember;
+
+  //################################################################################################
+  static const tp_utils::StringID& type()
+  {
+    return stringSID();
+  }
+
+  //################################################################################################
+  static void append(std::string& output, const std::string& value)
+  {
+    output += value;
+  }
+
+  //################################################################################################
+  static void parse(std::string& error, std::string_view data, std::string& value)
+  {
+    TP_UNUSED(error);
+    value = data;
+  }
+};
+
+//##################################################################################################
+template<>
+struct ReflectType<tp_utils::StringID>
+{
+  using MemberType = StringIDMember;
+
+  //################################################################################################
+  static const tp_utils::StringID& type()
+  {
+    return stringIDSID();
+  }
+
+  //################################################################################################
+  static void append(std::string& output, const tp_utils::StringID& value)
+  {
+    output += value.toString();
+  }
+
+  //################################################################################################
+  static void parse(std::string& error, std::string_view data, tp_utils::StringID& value)
+  {
+    TP_UNUSED(error);
+    value = std::string(data);
+  }
+};
+
+//##################################################################################################
+//! A field of struct S with type T, see TP_DATA_REFLECT.
+template<typename S, typename T>
+struct ReflectField
+{
+  using ValueType = T;
+
+  const char* name;
+  T S::* pointer;
+};
+
+//##################################################################################################
+template<typename S, typename T>
+constexpr ReflectField<S, T> reflectField(const char* name, T S::* pointer)
+{
+  return ReflectField<S, T>{name, pointer};
+}
+
+//##################################################################################################
+//! The fields declared for S with TP_DATA_REFLECT, as a tuple of ReflectField.
+template<typename S>
+auto reflectFields()
+{
+  return tpDataReflectFields(static_cast<const S*>(nullptr));
+}
+
+//##################################################################################################
+//! Save a struct using the same format as CollectionFactory::saveToData().
+/*!
+Each field is formatted straight into data so no AbstractMember objects are created and no member
+factory is looked up. The output can be loaded into a Collection with CollectionFactory, every
+member is given the timestamp of the collection.
+
+\param error Set if the data could not be saved.
+\param input The struct to save.
+\param name The name of the collection.
+\param timestampMS The timestamp of the collection.
+\param data The saved struct will be appended to this.
+*/
+template<typename S>
+void saveStructToData(std::string& error,
+                      const S& input,
+                      const std::string& name,
+                      int64_t timestampMS,
+                      std::string& data)
+{
+  std::string timestamp = std::to_string(timestampMS);
+  blob::addPart(data, "name", name);
+  blob::addPart(data, "timestamp", timestamp);
+
+  std::apply([&](const auto&... field)
+  {
+    auto saveField = [&](const auto& field)
+    {
+      using Type = ReflectType<typename std::decay_t<decltype(field)>::ValueType>;
+      if(!error.empty())
+        return;
+
+      blob::addPart(data, "member", field.name);
+      blob::addPart(data, "type", Type::type().keyString());
+      blob::addPart(data, "timestamp", timestamp);
+      size_t lengthOffset = blob::beginPart(data, "data");
+      Type::append(data, input.*field.pointer);
+      blob::endPart(error, data, lengthOffset);
+    };
+    (saveField(field), ...);
+  }, reflectFields<S>());
+}
+
+//##################################################################################################
+//! Load a struct from the output of saveStructToData() or CollectionFactory::saveToData().
+/*!
+Members are matched to fields by name and parsed straight into the struct. Members that are not
+fields of the struct are skipped and fields that are not in the data keep their current value.
+
+\param error Set if the data is malformed, if a member has a different type to its field, or if a
+value can't be parsed.
+\param data The saved data.
+\param output The fields of this will be set from the data.
+\return True on success.
+*/
+template<typename S>
+bool loadStructFromData(std::string& error, std::string_view data, S& output)
+{
+  auto fields = reflectFields<S>();
+
+  std::string_view memberName;
+  std::string_view memberType;
+  std::string_view memberData;
+  bool hasData=false;
+
+  auto loadMember = [&]()
+  {
+    if(!hasData)
+      return true;
+    hasData = false;
+
+    bool ok=true;
+    std::apply([&](const auto&... field)
+    {
+      auto loadField = [&](const auto& field)
+      {
+        using Type = ReflectType<typename std::decay_t<decltype(field)>::ValueType>;
+        if(memberName != field.name)
+          return false;
+
+        if(memberType != Type::type().keyString())
+        {
+          error = "Wrong type for member: " + std::string(memberName);
+          ok = false;
+          return true;
+        }
+
+        Type::parse(error, memberData, output.*field.pointer);
+        ok = error.empty();
+        return true;
+      };
+      (loadField(field) || ...);
+    }, fields);
+    return ok;
+  };
+
+  size_t startFrom=0;
+  std::string key;
+  size_t partOffset=0;
+  size_t partLen=0;
+  while(blob::parsePart(error, data.data(), data.size(), startFrom, key, partOffset, partLen))
+  {
+    std::string_view part(data.data()+partOffset, partLen);
+    if(key == "member")
+    {
+      if(!loadMember())
+        return false;
+      memberName = part;
+      memberType = std::string_view();
+    }
+    else if(key == "type")
+      memberType = part;
+    else if(key == "data")
+    {
+      memberData = part;
+      hasData = true;
+    }
+  }
+
+  if(!error.empty())
+    return false;
+
+  return loadMember();
+}
+
+//##################################################################################################
+//! Add a member to a Collection for each field of a struct.
+template<typename S>
+void structToCollection(const S& input, Collection& output)
+{
+  std::apply([&](const auto&... field)
+  {
+    auto addField = [&](const auto& field)
+    {
+      using Type = ReflectType<typename std::decay_t<decltype(field)>::ValueType>;
+      auto member = std::make_shared<typename Type::MemberType>(tp_utils::StringID(field.name));
+      member->data = input.*field.pointer;
+      member->setTimestampMS(output.timestampMS());
+      output.addMember(member);
+    };
+    (addField(field), ...);
+  }, reflectFields<S>());
+}
+
+//##################################################################################################
+//! Set the fields of a struct from the members of a Collection.
+/*!
+Fields that are not in the collection keep their current value.
+
+\param error Set if a member has a different type to its field.
+\return True on success.
+*/
+template<typename S>
+bool structFromCollection(std::string& error, const Collection& collection, S& output)
+{
+  std::apply([&](const auto&... field)
+  {
+    auto copyField = [&](const auto& field)
+    {
+      using Type = ReflectType<typename std::decay_t<decltype(field)>::ValueType>;
+      tp_utils::StringID name(field.name);
+      const auto& member = collection.member(name);
+      if(!member || !error.empty())
+        return;
+
+      if(auto m = dynamic_cast<const typename Type::MemberType*>(member.get()); m)
+        output.*field.pointer = m->data;
+      else
+        error = "Wrong type for member: " + name.toString();
+    };
+    (copyField(field), ...);
+  }, reflectFields<S>());
+
+  return error.empty();
+}
+
+}
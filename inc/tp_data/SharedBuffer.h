@@ -0,0 +1,90 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <memory>
+#include <string_view>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! A reference counted view of an immutable block of bytes.
+/*!
+A SharedBuffer points at a range of bytes and holds a reference to whatever owns them, this can be
+a string, an aligned allocation, or a memory mapped file. Copying a SharedBuffer or taking a slice
+of it never copies the bytes, so members can reference data in the buffer that they were loaded
+from.
+*/
+class TP_DATA_SHARED_EXPORT SharedBuffer
+{
+public:
+  //################################################################################################
+  SharedBuffer();
+
+  //################################################################################################
+  //! Take ownership of a string, this does not copy the bytes.
+  static SharedBuffer fromString(std::string&& data);
+
+  //################################################################################################
+  //! Copy bytes into a new 64 byte aligned buffer.
+  static SharedBuffer copy(const void* data, size_t size);
+
+  //################################################################################################
+  //! Allocate a new zero filled 64 byte aligned buffer that can be written with mutableData().
+  static SharedBuffer allocate(size_t size);
+
+  //################################################################################################
+  //! Memory map a file read only.
+  /*!
+  If memory mapping is not supported on this platform the file will be read into memory instead.
+
+  \param error This will be set on error.
+  \param path The file to map.
+  \return The mapped file or an empty buffer on error.
+  */
+  static SharedBuffer mapFile(std::string& error, const std::string& path);
+
+  //################################################################################################
+  const char* data() const;
+
+  //################################################################################################
+  size_t size() const;
+
+  //################################################################################################
+  bool empty() const;
+
+  //################################################################################################
+  std::string_view view() const;
+
+  //################################################################################################
+  //! Copy the bytes into a string.
+  std::string toString() const;
+
+  //################################################################################################
+  //! Return a view of part of this buffer that shares ownership of the bytes.
+  /*!
+  The range is clamped to the size of this buffer.
+  */
+  SharedBuffer slice(size_t offset, size_t size) const;
+
+  //################################################################################################
+  //! Returns writable bytes if this buffer was created with allocate() and is not shared.
+  /*!
+  This returns nullptr for buffers that are shared with other SharedBuffer objects or that wrap
+  read only memory, the caller should copy the data in that case.
+  */
+  char* mutableData();
+
+  //################################################################################################
+  //! Returns the object that owns the bytes, useful for checking if buffers share storage.
+  const std::shared_ptr<const void>& owner() const;
+
+private:
+  std::shared_ptr<const void> m_owner;
+  const char* m_data{nullptr};
+  size_t m_size{0};
+  bool m_writable{false};
+};
+
+}
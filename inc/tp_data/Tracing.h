@@ -0,0 +1,133 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include "json.hpp" // IWYU pragma: keep
+
+#include <chrono>
+
+//##################################################################################################
+//! Tracing of load and save operations.
+/*!
+Tracing is enabled at compile time by defining TP_DATA_ENABLE_TRACING, without it the TP_DATA_TRACE
+macros expand to nothing and their arguments are not evaluated. When compiled in, events are only
+recorded between TraceRecorder::start() and TraceRecorder::stop(), the result can be written as a
+Chrome trace JSON file and opened in chrome://tracing or https://ui.perfetto.dev.
+
+\code
+tp_data::TraceRecorder::start();
+collectionFactory.loadFromData(error, data, collection);
+tp_data::TraceRecorder::stop();
+tp_data::TraceRecorder::writeChromeTrace("load.json");
+\endcode
+*/
+#ifdef TP_DATA_ENABLE_TRACING
+//! Trace the enclosing scope, name must be a string literal.
+#  define TP_DATA_TRACE_SCOPE(var, name) tp_data::TraceScope var(name)
+//! Trace the enclosing scope as an operation on a member.
+#  define TP_DATA_TRACE_MEMBER_SCOPE(var, name, member, type) tp_data::TraceScope var(name, member, type)
+//! Set the number of bytes processed by a scope.
+#  define TP_DATA_TRACE_BYTES(var, bytes) var.setBytes(bytes)
+#else
+#  define TP_DATA_TRACE_SCOPE(var, name)
+#  define TP_DATA_TRACE_MEMBER_SCOPE(var, name, member, type)
+#  define TP_DATA_TRACE_BYTES(var, bytes)
+#endif
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Collects trace events from all threads.
+class TP_DATA_SHARED_EXPORT TraceRecorder
+{
+public:
+  //################################################################################################
+  //! Clear any previous events and start recording.
+  static void start();
+
+  //################################################################################################
+  //! Stop recording, the recorded events are kept until the next call to start().
+  static void stop();
+
+  //################################################################################################
+  static bool recording();
+
+  //################################################################################################
+  //! The recorded events in the Chrome trace event format.
+  static nlohmann::json chromeTrace();
+
+  //################################################################################################
+  //! Write the recorded events to a Chrome trace JSON file.
+  static bool writeChromeTrace(const std::string& path);
+
+  //################################################################################################
+  //! Add a complete event, this is called by TraceScope.
+  static void addEvent(const char* name,
+                       std::string&& member,
+                       std::string&& type,
+                       size_t bytes,
+                       std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end);
+};
+
+//##################################################################################################
+//! Records a trace event from construction to destruction, use the TP_DATA_TRACE macros.
+class TraceScope
+{
+  TP_NONCOPYABLE(TraceScope);
+public:
+  //################################################################################################
+  TraceScope(const char* name):
+    m_name(name),
+    m_recording(TraceRecorder::recording())
+  {
+    if(m_recording)
+      m_start = std::chrono::steady_clock::now();
+  }
+
+  //################################################################################################
+  TraceScope(const char* name, const tp_utils::StringID& member, const tp_utils::StringID& type):
+    TraceScope(name)
+  {
+    if(m_recording)
+    {
+      m_member = member.toString();
+      m_type = type.toString();
+    }
+  }
+
+  //################################################################################################
+  TraceScope(const char* name, const std::string& member, const std::string& type):
+    TraceScope(name)
+  {
+    if(m_recording)
+    {
+      m_member = member;
+      m_type = type;
+    }
+  }
+
+  //################################################################################################
+  ~TraceScope()
+  {
+    if(m_recording)
+      TraceRecorder::addEvent(m_name, std::move(m_member), std::move(m_type), m_bytes, m_start, std::chrono::steady_clock::now());
+  }
+
+  //################################################################################################
+  void setBytes(size_t bytes)
+  {
+    m_bytes = bytes;
+  }
+
+private:
+  const char* m_name;
+  bool m_recording;
+  std::chrono::steady_clock::time_point m_start;
+  std::string m_member;
+  std::string m_type;
+  size_t m_bytes{0};
+};
+
+}
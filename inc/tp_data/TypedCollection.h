@@ -0,0 +1,218 @@
+#pragma once
+
+#include "tp_data/Collection.h"
+#include "tp_data/CollectionFactory.h"
+#include "tp_data/LoadFilter.h"
+
+#include "tp_utils/TimeUtils.h"
+
+#include <array>
+#include <tuple>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! Describes one member of a TypedCollection, M is the member class and name returns its name.
+/*!
+The name is a function rather than a string so that the IDs declared with TP_DECLARE_ID can be used
+directly, for example Field<FloatMember, weightSID>.
+*/
+template<typename M, const tp_utils::StringID& (*nameFunction)()>
+struct Field
+{
+  using MemberType = M;
+
+  //################################################################################################
+  static const tp_utils::StringID& name()
+  {
+    return nameFunction();
+  }
+};
+
+namespace detail
+{
+//##################################################################################################
+template<typename F, typename... Fields>
+struct FieldIndex;
+
+//##################################################################################################
+template<typename F, typename... Fields>
+struct FieldIndex<F, F, Fields...> : std::integral_constant<size_t, 0>{};
+
+//##################################################################################################
+template<typename F, typename G, typename... Fields>
+struct FieldIndex<F, G, Fields...> : std::integral_constant<size_t, 1 + FieldIndex<F, Fields...>::value>{};
+}
+
+//##################################################################################################
+//! A collection with a schema that is fixed at compile time.
+/*!
+The members are held by value in declaration order so accessing a member is a fixed offset with no
+lookup by name and no dynamic_cast. The members are ordinary member objects so they are saved
+with the same member factories as a Collection and the data is wire compatible with
+CollectionFactory::saveToData() and CollectionFactory::loadFromData().
+
+\code
+TP_DECLARE_ID(weightSID, "Weight");
+TP_DECLARE_ID(labelSID, "Label");
+
+using Sample = tp_data::TypedCollection<tp_data::Field<tp_data::FloatMember, weightSID>,
+                                        tp_data::Field<tp_data::StringMember, labelSID>>;
+
+Sample sample;
+sample.get<0>().data = 0.5f;
+sample.get<tp_data::Field<tp_data::StringMember, labelSID>>().data = "cat";
+sample.loadFromData(error, collectionFactory, data);
+\endcode
+*/
+template<typename... Fields>
+class TypedCollection
+{
+  TP_NONCOPYABLE(TypedCollection);
+public:
+  static constexpr size_t fieldCount = sizeof...(Fields);
+
+  //################################################################################################
+  template<size_t I>
+  using MemberType = typename std::tuple_element_t<I, std::tuple<Fields...>>::MemberType;
+
+  //################################################################################################
+  TypedCollection():
+    m_members{Fields::name()...}
+  {
+
+  }
+
+  //################################################################################################
+  const std::string& name() const
+  {
+    return m_name;
+  }
+
+  //################################################################################################
+  void setName(const std::string& name)
+  {
+    m_name = name;
+  }
+
+  //################################################################################################
+  int64_t timestampMS() const
+  {
+    return m_timestampMS;
+  }
+
+  //################################################################################################
+  void setTimestampMS(int64_t timestampMS)
+  {
+    m_timestampMS = timestampMS;
+  }
+
+  //################################################################################################
+  //! Access a member by its index in the field list.
+  template<size_t I>
+  MemberType<I>& get()
+  {
+    return std::get<I>(m_members);
+  }
+
+  //################################################################################################
+  template<size_t I>
+  const MemberType<I>& get() const
+  {
+    return std::get<I>(m_members);
+  }
+
+  //################################################################################################
+  //! Access a member by its Field type.
+  template<typename F>
+  typename F::MemberType& get()
+  {
+    return std::get<detail::FieldIndex<F, Fields...>::value>(m_members);
+  }
+
+  //################################################################################################
+  template<typename F>
+  const typename F::MemberType& get() const
+  {
+    return std::get<detail::FieldIndex<F, Fields...>::value>(m_members);
+  }
+
+  //################################################################################################
+  //! The members in field order.
+  std::array<const AbstractMember*, fieldCount> members() const
+  {
+    return std::apply([](const auto&... member){return std::array<const AbstractMember*, fieldCount>{&member...};}, m_members);
+  }
+
+  //################################################################################################
+  //! Add a copy of each member to a Collection.
+  void toCollection(Collection& output) const
+  {
+    output.setName(m_name);
+    output.setTimestampMS(m_timestampMS);
+    std::apply([&](const auto&... member){(addCopy(output, member), ...);}, m_members);
+  }
+
+  //################################################################################################
+  //! Copy the members from a Collection, every field must be present with the correct type.
+  void fromCollection(std::string& error, const Collection& collection)
+  {
+    m_name = collection.name();
+    m_timestampMS = collection.timestampMS();
+    std::apply([&](auto&... member){(copyFrom(error, collection, member), ...);}, m_members);
+  }
+
+  //################################################################################################
+  //! Save using the same format as CollectionFactory::saveToData(), no members are copied.
+  void saveToData(std::string& error, const CollectionFactory& collectionFactory, std::string& data) const
+  {
+    auto m = members();
+    collectionFactory.saveToData(error, m_name, m_timestampMS, std::vector<const AbstractMember*>(m.begin(), m.end()), data);
+  }
+
+  //################################################################################################
+  //! Load from the output of CollectionFactory::saveToData(), other members in the data are skipped.
+  void loadFromData(std::string& error, const CollectionFactory& collectionFactory, const std::string& data)
+  {
+    LoadFilter filter;
+    (filter.addName(Fields::name().toString()), ...);
+
+    Collection collection;
+    collectionFactory.loadFromData(error, data, collection, filter);
+    if(error.empty())
+      fromCollection(error, collection);
+  }
+
+private:
+  //################################################################################################
+  template<typename M>
+  static void addCopy(Collection& output, const M& member)
+  {
+    auto copy = std::make_shared<M>(member.name());
+    copy->copyData(member);
+    copy->setTimestampMS(member.timestampMS());
+    output.addMember(copy);
+  }
+
+  //################################################################################################
+  template<typename M>
+  static void copyFrom(std::string& error, const Collection& collection, M& member)
+  {
+    auto source = collection.memberCast<M>(member.name());
+    if(!source)
+    {
+      error = "Missing member or wrong type: " + member.name().toString();
+      return;
+    }
+
+    member.copyData(*source);
+    member.setTimestampMS(source->timestampMS());
+  }
+
+  std::string m_name;
+  int64_t m_timestampMS{tp_utils::currentTimeMS()};
+  std::tuple<typename Fields::MemberType...> m_members;
+};
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "tp_data/Globals.h"
+
+#include <type_traits>
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! SIMD reductions over contiguous arrays of numbers.
+/*!
+These are used by the vector members and are intended for CollectionBatch columns. SSE2 is used on
+x86 and NEON on ARM, other platforms get a portable version. Floating point sums are accumulated in
+several lanes so the result may differ in the last bits from a sequential sum.
+
+The min and max of an empty array are 0.
+*/
+
+//##################################################################################################
+TP_DATA_SHARED_EXPORT float vectorSum(const float* data, size_t count);
+TP_DATA_SHARED_EXPORT float vectorMin(const float* data, size_t count);
+TP_DATA_SHARED_EXPORT float vectorMax(const float* data, size_t count);
+TP_DATA_SHARED_EXPORT float vectorDot(const float* a, const float* b, size_t count);
+
+//##################################################################################################
+TP_DATA_SHARED_EXPORT double vectorSum(const double* data, size_t count);
+TP_DATA_SHARED_EXPORT double vectorMin(const double* data, size_t count);
+TP_DATA_SHARED_EXPORT double vectorMax(const double* data, size_t count);
+TP_DATA_SHARED_EXPORT double vectorDot(const double* a, const double* b, size_t count);
+
+//##################################################################################################
+TP_DATA_SHARED_EXPORT int64_t vectorSum(const int32_t* data, size_t count);
+TP_DATA_SHARED_EXPORT int32_t vectorMin(const int32_t* data, size_t count);
+TP_DATA_SHARED_EXPORT int32_t vectorMax(const int32_t* data, size_t count);
+TP_DATA_SHARED_EXPORT int64_t vectorDot(const int32_t* a, const int32_t* b, size_t count);
+
+//##################################################################################################
+//! Portable versions for the remaining types, these are written so that compilers can vectorize.
+template<typename T>
+auto vectorSum(const T* data, size_t count)
+{
+  using R = std::conditional_t<std::is_floating_point_v<T>, T, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+  R s[4]={0, 0, 0, 0};
+  size_t i=0;
+  for(; i+4<=count; i+=4)
+  {
+    s[0] += R(data[i+0]);
+    s[1] += R(data[i+1]);
+    s[2] += R(data[i+2]);
+    s[3] += R(data[i+3]);
+  }
+  for(; i<count; i++)
+    s[0] += R(data[i]);
+  return R((s[0]+s[1]) + (s[2]+s[3]));
+}
+
+//##################################################################################################
+template<typename T>
+T vectorMin(const T* data, size_t count)
+{
+  if(count==0)
+    return T(0);
+  T m = data[0];
+  for(size_t i=1; i<count; i++)
+    m = (data[i]<m)?data[i]:m;
+  return m;
+}
+
+//##################################################################################################
+template<typename T>
+T vectorMax(const T* data, size_t count)
+{
+  if(count==0)
+    return T(0);
+  T m = data[0];
+  for(size_t i=1; i<count; i++)
+    m = (data[i]>m)?data[i]:m;
+  return m;
+}
+
+//##################################################################################################
+template<typename T>
+auto vectorDot(const T* a, const T* b, size_t count)
+{
+  using R = std::conditional_t<std::is_floating_point_v<T>, T, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+  R s[4]={0, 0, 0, 0};
+  size_t i=0;
+  for(; i+4<=count; i+=4)
+  {
+    s[0] += R(a[i+0])*R(b[i+0]);
+    s[1] += R(a[i+1])*R(b[i+1]);
+    s[2] += R(a[i+2])*R(b[i+2]);
+    s[3] += R(a[i+3])*R(b[i+3]);
+  }
+  for(; i<count; i++)
+    s[0] += R(a[i])*R(b[i]);
+  return R((s[0]+s[1]) + (s[2]+s[3]));
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "tp_data/AbstractMemberFactory.h"
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! An immutable block of binary data.
+/*!
+The bytes are held in a reference counted SharedBuffer. Cloning, copying, and slicing a BytesMember
+share the buffer rather than copying it. When loaded with the SharedBuffer overload of
+CollectionFactory::loadFromData, or from a member file by loadFromPath, the member points straight
+into the source buffer or memory mapped file.
+
+Use this in place of StringMember for binary payloads.
+*/
+class BytesMember : public tp_data::AbstractMember
+{
+public:
+  //################################################################################################
+  BytesMember(const tp_utils::StringID& name=tp_utils::StringID(), const SharedBuffer& data_=SharedBuffer());
+
+  //################################################################################################
+  ~BytesMember();
+
+  //################################################################################################
+  //! Return a new member that references part of this members data.
+  std::shared_ptr<BytesMember> slice(size_t offset, size_t size) const;
+
+  //################################################################################################
+  static BytesMember* fromData(std::string& error, std::string_view data);
+
+  //################################################################################################
+  std::string toData() const;
+
+  //################################################################################################
+  //! Append the saved form of this member to output.
+  void appendData(std::string& output) const;
+
+  //################################################################################################
+  void copyData(const BytesMember& other);
+
+  //################################################################################################
+  //! The buffer is counted in full even if it is shared with other members or memory mapped.
+  size_t memoryUsage() const override;
+
+  static const std::string extension;
+  SharedBuffer data;
+};
+
+//##################################################################################################
+class BytesMemberFactory : public AbstractMemberFactory
+{
+public:
+  //################################################################################################
+  BytesMemberFactory(TPPixel color);
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> clone(std::string& error, const AbstractMember& member) const override;
+
+  //################################################################################################
+  void save(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override;
+
+  //################################################################################################
+  void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> loadShared(std::string& error, const SharedBuffer& data) const override;
+
+  //################################################################################################
+  bool sharesLoadedData() const override;
+};
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "tp_data/AbstractMemberFactory.h"
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! How the pixels of an ImageMember are compressed when saved.
+enum class ImageCompression : uint8_t
+{
+  None          = 0, //!< Raw RGBA pixels.
+  RowPrediction = 1  //!< Each row is predicted from the row above then run length encoded.
+};
+
+//##################################################################################################
+//! An image made of TPPixel values.
+/*!
+The image is saved in a simple binary container, the rows are split into bands that are compressed
+independently and an offset table points to each band. This allows a region of interest to be read
+using readRegion() by decoding only the bands that overlap it.
+
+RowPrediction compression is lossless, each row is replaced by its difference from the row above
+(the first row of each band by the difference from the pixel to the left) and the result is run
+length encoded. This is fast and works well on images with large flat or smooth areas.
+*/
+class ImageMember : public tp_data::AbstractMember
+{
+public:
+  //################################################################################################
+  ImageMember(const tp_utils::StringID& name=tp_utils::StringID());
+
+  //################################################################################################
+  ~ImageMember();
+
+  //################################################################################################
+  //! Resize the image, the pixels are filled with the default TPPixel.
+  void setSize(size_t width, size_t height);
+
+  //################################################################################################
+  size_t width() const;
+
+  //################################################################################################
+  size_t height() const;
+
+  //################################################################################################
+  TPPixel& pixel(size_t x, size_t y);
+
+  //################################################################################################
+  const TPPixel& pixel(size_t x, size_t y) const;
+
+  //################################################################################################
+  static ImageMember* fromData(std::string& error, std::string_view data);
+
+  //################################################################################################
+  std::string toData(ImageCompression compression=ImageCompression::RowPrediction) const;
+
+  //################################################################################################
+  //! Append the saved form of this member to output.
+  void appendData(std::string& output, ImageCompression compression=ImageCompression::RowPrediction) const;
+
+  //################################################################################################
+  void copyData(const ImageMember& other);
+
+  //################################################################################################
+  size_t memoryUsage() const override;
+
+  //################################################################################################
+  //! Read part of a saved image without decoding all of it.
+  /*!
+  Only the bands of rows that overlap the region are decoded. This can be used with a memory
+  mapped member file (see SharedBuffer::mapFile()) to read a small part of a large image.
+
+  \param error This will be set on error.
+  \param data The saved image, the output of toData().
+  \param size The size of data in bytes.
+  \param x The left of the region.
+  \param y The top of the region.
+  \param width The width of the region.
+  \param height The height of the region.
+  \param pixels This will be filled with width*height pixels in row order.
+  \return True on success.
+  */
+  static bool readRegion(std::string& error,
+                         const char* data,
+                         size_t size,
+                         size_t x,
+                         size_t y,
+                         size_t width,
+                         size_t height,
+                         std::vector<TPPixel>& pixels);
+
+  static const std::string extension;
+
+  //! width*height pixels in row order.
+  std::vector<TPPixel> data;
+
+private:
+  size_t m_width{0};
+  size_t m_height{0};
+};
+
+//##################################################################################################
+class ImageMemberFactory : public AbstractMemberFactory
+{
+public:
+  //################################################################################################
+  ImageMemberFactory(TPPixel color, ImageCompression compression=ImageCompression::RowPrediction);
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> clone(std::string& error, const AbstractMember& member) const override;
+
+  //################################################################################################
+  void save(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override;
+
+  //################################################################################################
+  void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const override;
+
+private:
+  ImageCompression m_compression;
+};
+
+}
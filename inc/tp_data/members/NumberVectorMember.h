@@ -0,0 +1,127 @@
+#pragma once
+
+#include "tp_data/AbstractMemberFactory.h"
+#include "tp_data/AlignedAllocator.h"
+#include "tp_data/MemoryUsage.h"
+#include "tp_data/BinaryUtils.h"
+#include "tp_data/VectorKernels.h"
+
+namespace tp_data
+{
+//##################################################################################################
+struct NumberVectorMemberExtension
+{
+  static const std::string extension;
+};
+
+//##################################################################################################
+//! A dense array of numbers.
+/*!
+The values are held in 64 byte aligned storage and are saved as raw little endian bytes, so on
+little endian hosts saving and loading is a single memcpy.
+*/
+template<typename T, const tp_utils::StringID&(*type_)()>
+class NumberVectorMember : public tp_data::AbstractMember, public NumberVectorMemberExtension
+{
+public:
+  using ValueType = T;
+
+  //################################################################################################
+  NumberVectorMember(const tp_utils::StringID& name=tp_utils::StringID()):
+    AbstractMember(name, type_())
+  {
+
+  }
+
+  //################################################################################################
+  //! The type of this member, without needing an instance.
+  static const tp_utils::StringID& memberType()
+  {
+    return type_();
+  }
+
+  //################################################################################################
+  static NumberVectorMember* fromData(std::string& error, std::string_view data)
+  {
+    if(data.size() % sizeof(T))
+    {
+      error = "Vector data size is not a multiple of the value size for: " + type_().toString();
+      return nullptr;
+    }
+
+    auto member = new NumberVectorMember<T, type_>();
+    member->data.resize(data.size() / sizeof(T));
+    readLittleEndian(data.data(), member->data.data(), member->data.size());
+    return member;
+  }
+
+  //################################################################################################
+  std::string toData() const
+  {
+    std::string output;
+    appendData(output);
+    return output;
+  }
+
+  //################################################################################################
+  //! Append the saved form of this member to output.
+  void appendData(std::string& output) const
+  {
+    appendLittleEndian(output, data.data(), data.size());
+  }
+
+  //################################################################################################
+  void copyData(const NumberVectorMember<T, type_>& other)
+  {
+    data = other.data;
+  }
+
+  //################################################################################################
+  size_t memoryUsage() const override
+  {
+    return sizeof(NumberVectorMember<T, type_>) + heapMemoryUsage(data);
+  }
+
+  //################################################################################################
+  auto sum() const
+  {
+    return vectorSum(data.data(), data.size());
+  }
+
+  //################################################################################################
+  T min() const
+  {
+    return vectorMin(data.data(), data.size());
+  }
+
+  //################################################################################################
+  T max() const
+  {
+    return vectorMax(data.data(), data.size());
+  }
+
+  //################################################################################################
+  //! The dot product of the first n values of each vector, where n is the length of the shortest.
+  auto dot(const NumberVectorMember<T, type_>& other) const
+  {
+    return vectorDot(data.data(), other.data.data(), std::min(data.size(), other.data.size()));
+  }
+
+  AlignedVector<T> data;
+};
+
+//##################################################################################################
+using  FloatVectorMember = tp_data::NumberVectorMember<   float,  floatVectorSID>;
+using DoubleVectorMember = tp_data::NumberVectorMember<  double, doubleVectorSID>;
+using  Int32VectorMember = tp_data::NumberVectorMember< int32_t,  int32VectorSID>;
+using  Int64VectorMember = tp_data::NumberVectorMember< int64_t,  int64VectorSID>;
+using  UInt8VectorMember = tp_data::NumberVectorMember< uint8_t,  uint8VectorSID>;
+
+//##################################################################################################
+using  FloatVectorMemberFactory = tp_data::MultiDataMemberFactoryTemplate< FloatVectorMember,  floatVectorSID>;
+using DoubleVectorMemberFactory = tp_data::MultiDataMemberFactoryTemplate<DoubleVectorMember, doubleVectorSID>;
+using  Int32VectorMemberFactory = tp_data::MultiDataMemberFactoryTemplate< Int32VectorMember,  int32VectorSID>;
+using  Int64VectorMemberFactory = tp_data::MultiDataMemberFactoryTemplate< Int64VectorMember,  int64VectorSID>;
+using  UInt8VectorMemberFactory = tp_data::MultiDataMemberFactoryTemplate< UInt8VectorMember,  uint8VectorSID>;
+
+}
@@ -5,6 +5,14 @@
 namespace tp_data
 {
 
+//##################################################################################################
+//! How a StringIDVectorMember is saved.
+enum class StringIDVectorEncoding
+{
+  JSON,  //!< A pretty printed JSON array of strings, human readable.
+  Binary //!< A table of the distinct strings followed by varint indices into it.
+};
+
 //##################################################################################################
 class StringIDVectorMember : public tp_data::AbstractMember
 {
@@ -16,19 +24,59 @@ public:
   ~StringIDVectorMember();
 
   //################################################################################################
-  static StringIDVectorMember* fromData(std::string& error, const std::string& data);
+  //! Load from either encoding, the encoding is detected from the data.
+  /*!
+  In the binary encoding each distinct string is converted to a StringID once.
+  */
+  static StringIDVectorMember* fromData(std::string& error, std::string_view data);
+
+  //################################################################################################
+  std::string toData(StringIDVectorEncoding encoding=StringIDVectorEncoding::JSON) const;
 
   //################################################################################################
-  std::string toData() const;
+  //! Append the saved form of this member to output.
+  void appendData(std::string& output, StringIDVectorEncoding encoding=StringIDVectorEncoding::JSON) const;
 
   //################################################################################################
   void copyData(const StringIDVectorMember& other);
 
+  //################################################################################################
+  size_t memoryUsage() const override;
+
   static const std::string extension;
+  static const std::string binaryExtension;
   std::vector<tp_utils::StringID> data;
 };
 
 //##################################################################################################
-using StringIDVectorMemberFactory = tp_data::MultiDataMemberFactoryTemplate<StringIDVectorMember, stringIDVectorSID>;
+class StringIDVectorMemberFactory : public AbstractMemberFactory
+{
+public:
+  //################################################################################################
+  /*!
+  \param color Color used for rendering node graphs.
+  \param encoding The encoding used to save members, both encodings can always be loaded. Binary is
+  smaller and faster but can't be read by versions that predate it, so it must be asked for.
+  */
+  StringIDVectorMemberFactory(TPPixel color, StringIDVectorEncoding encoding=StringIDVectorEncoding::JSON);
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> clone(std::string& error, const AbstractMember& member) const override;
+
+  //################################################################################################
+  void save(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override;
+
+  //################################################################################################
+  void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const override;
+
+private:
+  StringIDVectorEncoding m_encoding;
+};
 
 }
@@ -16,14 +16,21 @@ public:
   ~StringMember();
 
   //################################################################################################
-  static StringMember* fromData(std::string& error, const std::string& data);
+  static StringMember* fromData(std::string& error, std::string_view data);
 
   //################################################################################################
   std::string toData() const;
 
+  //################################################################################################
+  //! Append the saved form of this member to output.
+  void appendData(std::string& output) const;
+
   //################################################################################################
   void copyData(const StringMember& other);
 
+  //################################################################################################
+  size_t memoryUsage() const override;
+
   static const std::string extension;
   std::string data;
 };
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "tp_data/AbstractMemberFactory.h"
+
+namespace tp_data
+{
+
+//##################################################################################################
+//! The type of the values in a TensorMember.
+enum class TensorDType : uint8_t
+{
+  Float32 = 0,
+  Float64 = 1,
+  Int8    = 2,
+  UInt8   = 3,
+  Int16   = 4,
+  UInt16  = 5,
+  Int32   = 6,
+  UInt32  = 7,
+  Int64   = 8,
+  UInt64  = 9
+};
+
+//##################################################################################################
+//! The size of a single value in bytes, or 0 for an invalid type.
+size_t tensorDTypeSize(TensorDType dtype);
+
+//##################################################################################################
+std::string tensorDTypeToString(TensorDType dtype);
+
+//##################################################################################################
+//! An N-dimensional array of numbers.
+/*!
+The values are held in a SharedBuffer and are described by a dtype, a shape, and strides. The
+strides are measured in elements, not bytes, and must not be negative.
+
+The saved form is a header padded to a multiple of 64 bytes followed by the raw little endian
+values, and the factory asks CollectionFactory to align the data within blobs. This means that
+when a tensor is loaded from a memory mapped file (either a member file written by saveToPath or a
+blob written by saveToData and loaded with SharedBuffer::mapFile) the values are used in place
+without being copied.
+
+Modifying the values with mutableData() will copy them first if they are shared. A default
+constructed tensor is empty with shape {0}.
+*/
+class TensorMember : public tp_data::AbstractMember
+{
+public:
+  //################################################################################################
+  TensorMember(const tp_utils::StringID& name=tp_utils::StringID());
+
+  //################################################################################################
+  ~TensorMember();
+
+  //################################################################################################
+  //! Allocate a zero filled, contiguous, row major tensor.
+  /*!
+  If a dimension is negative or the size overflows an empty tensor with shape {0} is allocated.
+  */
+  void allocate(TensorDType dtype, const std::vector<int64_t>& shape);
+
+  //################################################################################################
+  //! Reference existing values.
+  /*!
+  \param error This will be set if the buffer is too small for the shape and strides.
+  \param dtype The type of the values.
+  \param shape The size of each dimension.
+  \param strides The distance in elements between values in each dimension, if this is empty the
+  tensor is contiguous and row major.
+  \param buffer The values, this is shared not copied.
+  */
+  void setBuffer(std::string& error,
+                 TensorDType dtype,
+                 const std::vector<int64_t>& shape,
+                 const std::vector<int64_t>& strides,
+                 const SharedBuffer& buffer);
+
+  //################################################################################################
+  TensorDType dtype() const;
+
+  //################################################################################################
+  const std::vector<int64_t>& shape() const;
+
+  //################################################################################################
+  //! The strides measured in elements.
+  const std::vector<int64_t>& strides() const;
+
+  //################################################################################################
+  //! The number of values in the tensor, the product of the shape.
+  size_t elementCount() const;
+
+  //################################################################################################
+  //! True if the strides describe a row major tensor with no gaps.
+  bool isContiguous() const;
+
+  //################################################################################################
+  const SharedBuffer& buffer() const;
+
+  //################################################################################################
+  const void* data() const;
+
+  //################################################################################################
+  //! Writable values, this will copy the buffer first if it is shared or read only.
+  void* mutableData();
+
+  //################################################################################################
+  template<typename T>
+  const T* dataAs() const
+  {
+    return static_cast<const T*>(data());
+  }
+
+  //################################################################################################
+  static TensorMember* fromData(std::string& error, std::string_view data);
+
+  //################################################################################################
+  //! Load referencing data rather than copying it where possible.
+  static TensorMember* fromSharedData(std::string& error, const SharedBuffer& data);
+
+  //################################################################################################
+  //! The saved form of this member, error is set if the shape and strides don't fit the buffer.
+  std::string toData(std::string& error) const;
+
+  //################################################################################################
+  //! Append the saved form of this member to output, nothing is appended on error.
+  void appendData(std::string& error, std::string& output) const;
+
+  //################################################################################################
+  void copyData(const TensorMember& other);
+
+  //################################################################################################
+  //! The buffer is counted in full even if it is shared with other members or memory mapped.
+  size_t memoryUsage() const override;
+
+  static const std::string extension;
+
+private:
+  TensorDType m_dtype{TensorDType::Float32};
+  std::vector<int64_t> m_shape{0};
+  std::vector<int64_t> m_strides{1};
+  SharedBuffer m_buffer;
+};
+
+//##################################################################################################
+class TensorMemberFactory : public AbstractMemberFactory
+{
+public:
+  //################################################################################################
+  TensorMemberFactory(TPPixel color);
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> clone(std::string& error, const AbstractMember& member) const override;
+
+  //################################################################################################
+  void save(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> load(std::string& error, const std::string& data) const override;
+
+  //################################################################################################
+  void saveAppend(std::string& error, const AbstractMember& member, std::string& data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> loadView(std::string& error, std::string_view data) const override;
+
+  //################################################################################################
+  std::shared_ptr<AbstractMember> loadShared(std::string& error, const SharedBuffer& data) const override;
+
+  //################################################################################################
+  bool sharesLoadedData() const override;
+
+  //################################################################################################
+  size_t dataAlignment() const override;
+};
+
+}
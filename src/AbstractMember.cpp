@@ -17,6 +17,16 @@ AbstractMember::AbstractMember(const tp_utils::StringID& name, const tp_utils::S
 //##################################################################################################
 AbstractMember::~AbstractMember() = default;
 
+//##################################################################################################
+AbstractMember::AbstractMember(const AbstractMember& other):
+  m_name(other.m_name),
+  m_type(other.m_type),
+  m_timestampMS(other.m_timestampMS),
+  m_typeIndex(other.typeIndex())
+{
+
+}
+
 //##################################################################################################
 const tp_utils::StringID& AbstractMember::name() const
 {
@@ -47,4 +57,22 @@ void AbstractMember::setTimestampMS(int64_t timestampMS)
   m_timestampMS = timestampMS;
 }
 
+//##################################################################################################
+size_t AbstractMember::memoryUsage() const
+{
+  return sizeof(AbstractMember);
+}
+
+//##################################################################################################
+size_t AbstractMember::typeIndex() const
+{
+  return m_typeIndex.load(std::memory_order_relaxed);
+}
+
+//##################################################################################################
+void AbstractMember::setTypeIndex(size_t typeIndex) const
+{
+  m_typeIndex.store(typeIndex, std::memory_order_relaxed);
+}
+
 }
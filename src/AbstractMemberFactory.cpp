@@ -3,6 +3,15 @@
 namespace tp_data
 {
 
+namespace
+{
+//CBOR tag 55799, a standard marker that identifies data as CBOR.
+const std::string cborSelfDescribeTag{"\xD9\xD9\xF7"};
+
+//0xC1 is never used by MessagePack and can't start JSON text, so it marks MessagePack data.
+const std::string msgpackMarker{"\xC1"};
+}
+
 //##################################################################################################
 AbstractMemberFactory::AbstractMemberFactory(const tp_utils::StringID& type, const std::string& extension, TPPixel color):
   m_type(type),
@@ -33,4 +42,128 @@ TPPixel AbstractMemberFactory::color() const
   return m_color;
 }
 
+//##################################################################################################
+size_t AbstractMemberFactory::typeIndex() const
+{
+  return m_typeIndex;
+}
+
+//##################################################################################################
+void AbstractMemberFactory::saveAppend(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  std::string memberData;
+  save(error, member, memberData);
+  data += memberData;
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> AbstractMemberFactory::loadView(std::string& error, std::string_view data) const
+{
+  return load(error, std::string(data));
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> AbstractMemberFactory::loadShared(std::string& error, const SharedBuffer& data) const
+{
+  return loadView(error, data.view());
+}
+
+//##################################################################################################
+bool AbstractMemberFactory::sharesLoadedData() const
+{
+  return false;
+}
+
+//##################################################################################################
+size_t AbstractMemberFactory::dataAlignment() const
+{
+  return 1;
+}
+
+//##################################################################################################
+void AbstractMemberFactory::saveBatch(std::string& error,
+                                      const std::vector<const AbstractMember*>& members,
+                                      std::string& data,
+                                      std::vector<size_t>& ends) const
+{
+  ends.reserve(ends.size() + members.size());
+  for(const auto member : members)
+  {
+    saveAppend(error, *member, data);
+    if(!error.empty())
+      return;
+    ends.push_back(data.size());
+  }
+}
+
+//##################################################################################################
+void AbstractMemberFactory::loadBatch(std::string& error,
+                                      const std::vector<std::string_view>& data,
+                                      std::vector<std::shared_ptr<AbstractMember>>& members) const
+{
+  members.reserve(members.size() + data.size());
+  for(const auto& memberData : data)
+  {
+    auto member = loadView(error, memberData);
+    if(!member || !error.empty())
+      return;
+    members.push_back(std::move(member));
+  }
+}
+
+//##################################################################################################
+bool AbstractMemberFactory::batchesMembers() const
+{
+  return false;
+}
+
+//##################################################################################################
+const std::string& jsonEncodingExtension(JSONEncoding encoding)
+{
+  static const std::string json{"json"};
+  static const std::string cbor{"cbor"};
+  static const std::string msgpack{"msgpack"};
+
+  switch(encoding)
+  {
+  case JSONEncoding::Text:        return json;
+  case JSONEncoding::CBOR:        return cbor;
+  case JSONEncoding::MessagePack: return msgpack;
+  }
+  return json;
+}
+
+//##################################################################################################
+void encodeJSON(const nlohmann::json& j, JSONEncoding encoding, std::string& data)
+{
+  switch(encoding)
+  {
+  case JSONEncoding::Text:
+    data += j.dump();
+    break;
+
+  case JSONEncoding::CBOR:
+    data += cborSelfDescribeTag;
+    nlohmann::json::to_cbor(j, data);
+    break;
+
+  case JSONEncoding::MessagePack:
+    data += msgpackMarker;
+    nlohmann::json::to_msgpack(j, data);
+    break;
+  }
+}
+
+//##################################################################################################
+nlohmann::json decodeJSON(std::string_view data)
+{
+  if(data.substr(0, cborSelfDescribeTag.size()) == cborSelfDescribeTag)
+    return nlohmann::json::from_cbor(data.begin()+int(cborSelfDescribeTag.size()), data.end());
+
+  if(data.substr(0, msgpackMarker.size()) == msgpackMarker)
+    return nlohmann::json::from_msgpack(data.begin()+int(msgpackMarker.size()), data.end());
+
+  return nlohmann::json::parse(data.begin(), data.end());
+}
+
 }
@@ -0,0 +1,181 @@
+#include "tp_data/BinaryDelta.h"
+#include "tp_data/BinaryUtils.h"
+
+#include <unordered_map>
+
+namespace tp_data
+{
+
+namespace
+{
+//The size of the blocks that base is indexed in, shorter matches are sent as inserts.
+constexpr size_t blockSize = 32;
+constexpr uint32_t multiplier = 0x01000193;
+
+//##################################################################################################
+uint32_t windowHash(const char* p)
+{
+  uint32_t h=0;
+  for(size_t i=0; i<blockSize; i++)
+    h = h*multiplier + uint8_t(p[i]);
+  return h;
+}
+
+//##################################################################################################
+//! multiplier^(blockSize-1), used to remove the oldest byte from the rolling hash.
+uint32_t outgoingFactor()
+{
+  uint32_t f=1;
+  for(size_t i=1; i<blockSize; i++)
+    f *= multiplier;
+  return f;
+}
+
+//##################################################################################################
+//! Each operation starts with a varint of (length << 1 | isCopy).
+void appendInsert(std::string& delta, const char* data, size_t len)
+{
+  if(len==0)
+    return;
+  appendVarint(delta, uint64_t(len)<<1);
+  delta.append(data, len);
+}
+
+//##################################################################################################
+void appendCopy(std::string& delta, size_t offset, size_t len)
+{
+  appendVarint(delta, (uint64_t(len)<<1) | 1);
+  appendVarint(delta, offset);
+}
+}
+
+//##################################################################################################
+void makeBinaryDelta(std::string_view base, std::string_view target, std::string& delta)
+{
+  appendVarint(delta, target.size());
+
+  const char* t = target.data();
+  size_t n = target.size();
+
+  if(base.size()<blockSize || n<blockSize)
+  {
+    appendInsert(delta, t, n);
+    return;
+  }
+
+  //Index the blocks of base, the first occurrence of a hash wins.
+  std::unordered_map<uint32_t, size_t> index;
+  index.reserve(base.size()/blockSize);
+  for(size_t offset=0; offset+blockSize<=base.size(); offset+=blockSize)
+    index.emplace(windowHash(base.data()+offset), offset);
+
+  const uint32_t outFactor = outgoingFactor();
+
+  size_t literalStart=0;
+  size_t i=0;
+  uint32_t h = windowHash(t);
+  while(i+blockSize<=n)
+  {
+    if(auto f=index.find(h); f!=index.end() && std::memcmp(base.data()+f->second, t+i, blockSize)==0)
+    {
+      //Extend the match backwards into the pending insert and then forwards.
+      size_t offset = f->second;
+      size_t start = i;
+      while(start>literalStart && offset>0 && base[offset-1]==t[start-1])
+      {
+        start--;
+        offset--;
+      }
+
+      size_t len = (i-start) + blockSize;
+      while(offset+len<base.size() && start+len<n && base[offset+len]==t[start+len])
+        len++;
+
+      appendInsert(delta, t+literalStart, start-literalStart);
+      appendCopy(delta, offset, len);
+
+      i = start+len;
+      literalStart = i;
+      if(i+blockSize<=n)
+        h = windowHash(t+i);
+      continue;
+    }
+
+    if(i+blockSize<n)
+      h = (h - uint8_t(t[i])*outFactor)*multiplier + uint8_t(t[i+blockSize]);
+    i++;
+  }
+
+  appendInsert(delta, t+literalStart, n-literalStart);
+}
+
+//##################################################################################################
+bool applyBinaryDelta(std::string& error,
+                      std::string_view base,
+                      std::string_view delta,
+                      std::string& output)
+{
+  const char* p = delta.data();
+  const char* end = p + delta.size();
+
+  uint64_t targetSize{0};
+  if(!readVarint(p, end, targetSize))
+  {
+    error = "Failed to read delta size.";
+    return false;
+  }
+
+  //The size is read from the delta so it can't be trusted, only reserve what a delta of this size
+  //could plausibly produce and let anything bigger grow as it is appended.
+  size_t outputStart = output.size();
+  if(targetSize <= uint64_t(base.size()) + uint64_t(delta.size()))
+    output.reserve(outputStart + size_t(targetSize));
+
+  while(p<end)
+  {
+    uint64_t op{0};
+    if(!readVarint(p, end, op))
+    {
+      error = "Failed to read delta operation.";
+      return false;
+    }
+
+    uint64_t len = op>>1;
+    if(len > targetSize - (output.size()-outputStart))
+    {
+      error = "Delta produced the wrong size.";
+      return false;
+    }
+
+    if(op&1)
+    {
+      uint64_t offset{0};
+      if(!readVarint(p, end, offset) || offset>base.size() || len>base.size()-offset)
+      {
+        error = "Delta copy is out of range.";
+        return false;
+      }
+      output.append(base.data()+offset, len);
+    }
+    else
+    {
+      if(len>uint64_t(end-p))
+      {
+        error = "Delta insert is out of range.";
+        return false;
+      }
+      output.append(p, len);
+      p += len;
+    }
+  }
+
+  if(output.size()-outputStart != targetSize)
+  {
+    error = "Delta produced the wrong size.";
+    return false;
+  }
+
+  return true;
+}
+
+}
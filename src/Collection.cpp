@@ -1,5 +1,6 @@
 #include "tp_data/Collection.h"
 #include "tp_data/AbstractMember.h"
+#include "tp_data/MemoryUsage.h"
 
 #include "tp_utils/TimeUtils.h"
 
@@ -77,6 +78,39 @@ void Collection::addMember(const std::shared_ptr<AbstractMember>& member)
   d->members.push_back(member);
 }
 
+//##################################################################################################
+void Collection::replaceMember(const std::shared_ptr<AbstractMember>& member)
+{
+  if(!member)
+    return;
+
+  for(auto& m : d->members)
+  {
+    if(m->name() == member->name())
+    {
+      m = member;
+      return;
+    }
+  }
+
+  d->members.push_back(member);
+}
+
+//##################################################################################################
+bool Collection::removeMember(const tp_utils::StringID& name)
+{
+  for(auto i=d->members.begin(); i!=d->members.end(); ++i)
+  {
+    if((*i)->name() == name)
+    {
+      d->members.erase(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 //##################################################################################################
 const std::vector<std::shared_ptr<AbstractMember>>& Collection::members() const
 {
@@ -95,6 +129,25 @@ const std::shared_ptr<AbstractMember>& Collection::member(const tp_utils::String
   return n;
 }
 
+//##################################################################################################
+size_t Collection::memoryUsage() const
+{
+  //Approximate size of the control block allocated by make_shared or shared_ptr.
+  constexpr size_t controlBlockSize = 3*sizeof(void*);
+
+  size_t total = sizeof(Collection) + sizeof(Private);
+  total += heapMemoryUsage(d->name);
+  total += heapMemoryUsage(d->errors);
+  for(const auto& error : d->errors)
+    total += heapMemoryUsage(error);
+
+  total += heapMemoryUsage(d->members);
+  for(const auto& member : d->members)
+    total += member->memoryUsage() + controlBlockSize;
+
+  return total;
+}
+
 //##################################################################################################
 void Collection::clear()
 {
@@ -0,0 +1,315 @@
+#include "tp_data/CollectionBatch.h"
+#include "tp_data/AbstractMember.h"
+#include "tp_data/Collection.h"
+#include "tp_data/CollectionFactory.h"
+#include "tp_data/members/NumberMember.h"
+
+#include <unordered_map>
+
+namespace tp_data
+{
+
+namespace
+{
+
+//##################################################################################################
+//! Describes how to move values between members of one type and a column.
+struct ColumnType
+{
+  tp_utils::StringID type;
+  size_t elementSize;
+  void (*get)(const AbstractMember& member, void* value);
+  void (*set)(AbstractMember& member, const void* value);
+  std::shared_ptr<AbstractMember> (*make)(const tp_utils::StringID& name, const void* value);
+};
+
+//##################################################################################################
+template<typename M>
+ColumnType makeColumnType()
+{
+  using T = typename M::ValueType;
+
+  ColumnType columnType;
+  columnType.type = M::memberType();
+  columnType.elementSize = sizeof(T);
+
+  columnType.get = [](const AbstractMember& member, void* value)
+  {
+    *static_cast<T*>(value) = static_cast<const M&>(member).data;
+  };
+
+  columnType.set = [](AbstractMember& member, const void* value)
+  {
+    static_cast<M&>(member).data = *static_cast<const T*>(value);
+  };
+
+  columnType.make = [](const tp_utils::StringID& name, const void* value)
+  {
+    return makeMember<M>(name, *static_cast<const T*>(value));
+  };
+
+  return columnType;
+}
+
+//##################################################################################################
+const ColumnType* findColumnType(const tp_utils::StringID& type)
+{
+  static const std::vector<ColumnType> columnTypes
+  {
+    makeColumnType<IntMember>(),
+    makeColumnType<SizeTMember>(),
+    makeColumnType<FloatMember>(),
+    makeColumnType<DoubleMember>(),
+    makeColumnType<Int64Member>(),
+    makeColumnType<UInt64Member>()
+  };
+
+  for(const auto& columnType : columnTypes)
+    if(columnType.type == type)
+      return &columnType;
+
+  return nullptr;
+}
+
+//##################################################################################################
+//! Pad to a multiple of 64 bytes so that kernels can always load whole registers.
+size_t paddedSize(size_t rows, size_t elementSize)
+{
+  return ((rows*elementSize + 63) / 64) * 64;
+}
+
+}
+
+//##################################################################################################
+struct CollectionBatch::Private
+{
+  TP_NONCOPYABLE(Private);
+  size_t size{0};
+  std::vector<tp_utils::StringID> columnNames;
+  std::unordered_map<tp_utils::StringID, std::pair<BatchColumn, const ColumnType*>> columns;
+
+  //################################################################################################
+  Private()=default;
+
+  //################################################################################################
+  std::pair<BatchColumn, const ColumnType*>* addColumn(const tp_utils::StringID& name,
+                                                       const tp_utils::StringID& type)
+  {
+    if(auto i=columns.find(name); i!=columns.end())
+      return (i->second.first.type == type)?&i->second:nullptr;
+
+    auto columnType = findColumnType(type);
+    if(!columnType)
+      return nullptr;
+
+    auto& column = columns[name];
+    column.second = columnType;
+    column.first.name = name;
+    column.first.type = type;
+    column.first.elementSize = columnType->elementSize;
+    column.first.values.resize(paddedSize(size, columnType->elementSize), 0);
+    column.first.present.resize(size, 0);
+    columnNames.push_back(name);
+    return &column;
+  }
+
+  //################################################################################################
+  void gatherRow(size_t row,
+                 const Collection& collection,
+                 const std::vector<tp_utils::StringID>& names)
+  {
+    for(const auto& member : collection.members())
+    {
+      std::pair<BatchColumn, const ColumnType*>* column=nullptr;
+
+      if(auto i=columns.find(member->name()); i!=columns.end())
+      {
+        if(i->second.first.type != member->type())
+          continue;
+        column = &i->second;
+      }
+      else if(names.empty())
+        column = addColumn(member->name(), member->type());
+
+      if(!column)
+        continue;
+
+      auto& c = column->first;
+      column->second->get(*member, c.values.data() + row*c.elementSize);
+      c.present[row] = 1;
+    }
+  }
+};
+
+//##################################################################################################
+CollectionBatch::CollectionBatch():
+  d(new Private())
+{
+
+}
+
+//##################################################################################################
+CollectionBatch::~CollectionBatch()
+{
+  delete d;
+}
+
+//##################################################################################################
+void CollectionBatch::gather(const std::vector<const Collection*>& collections,
+                             const std::vector<tp_utils::StringID>& names)
+{
+  clear();
+  d->size = collections.size();
+
+  //-- Create the named columns using the type found in the first collection that has each member --
+  for(const auto& name : names)
+  {
+    for(const auto& collection : collections)
+    {
+      if(!collection)
+        continue;
+
+      if(const auto& member = collection->member(name); member)
+      {
+        d->addColumn(name, member->type());
+        break;
+      }
+    }
+  }
+
+  //-- Fill the columns one row at a time ----------------------------------------------------------
+  for(size_t row=0; row<collections.size(); row++)
+    if(collections.at(row))
+      d->gatherRow(row, *collections.at(row), names);
+}
+
+//##################################################################################################
+void CollectionBatch::loadFromData(std::string& error,
+                                   const CollectionFactory& collectionFactory,
+                                   const std::vector<std::string>& data,
+                                   const std::vector<std::string>& subset)
+{
+  clear();
+  d->size = data.size();
+
+  std::vector<tp_utils::StringID> names;
+  names.reserve(subset.size());
+  for(const auto& name : subset)
+    names.emplace_back(name);
+
+  Collection collection;
+  for(size_t row=0; row<data.size(); row++)
+  {
+    collection.clear();
+    collectionFactory.loadFromData(error, data.at(row), collection, subset);
+    if(!error.empty())
+      return;
+
+    if(!names.empty())
+      for(const auto& name : names)
+        if(!d->columns.count(name))
+          if(const auto& member = collection.member(name); member)
+            d->addColumn(name, member->type());
+
+    d->gatherRow(row, collection, names);
+  }
+}
+
+//##################################################################################################
+size_t CollectionBatch::size() const
+{
+  return d->size;
+}
+
+//##################################################################################################
+void CollectionBatch::clear()
+{
+  d->size = 0;
+  d->columnNames.clear();
+  d->columns.clear();
+}
+
+//##################################################################################################
+const std::vector<tp_utils::StringID>& CollectionBatch::columnNames() const
+{
+  return d->columnNames;
+}
+
+//##################################################################################################
+const BatchColumn* CollectionBatch::column(const tp_utils::StringID& name) const
+{
+  auto i = d->columns.find(name);
+  return (i!=d->columns.end())?&i->second.first:nullptr;
+}
+
+//##################################################################################################
+BatchColumn* CollectionBatch::column(const tp_utils::StringID& name)
+{
+  auto i = d->columns.find(name);
+  return (i!=d->columns.end())?&i->second.first:nullptr;
+}
+
+//##################################################################################################
+BatchColumn* CollectionBatch::addColumn(const tp_utils::StringID& name, const tp_utils::StringID& type)
+{
+  auto column = d->addColumn(name, type);
+  return column?&column->first:nullptr;
+}
+
+//##################################################################################################
+void CollectionBatch::scatter(std::string& error,
+                              const tp_utils::StringID& name,
+                              const std::vector<Collection*>& collections) const
+{
+  auto i = d->columns.find(name);
+  if(i==d->columns.end())
+  {
+    error = "Failed to find column: " + name.toString();
+    return;
+  }
+
+  if(collections.size() != d->size)
+  {
+    error = "Collection count does not match batch size.";
+    return;
+  }
+
+  const auto& column = i->second.first;
+  const auto& columnType = *i->second.second;
+
+  for(size_t row=0; row<collections.size(); row++)
+  {
+    auto collection = collections.at(row);
+    if(!collection)
+      continue;
+
+    const uint8_t* value = column.values.data() + row*column.elementSize;
+
+    if(const auto& member = collection->member(name); member)
+    {
+      if(member->type() != column.type)
+      {
+        error = "Member type does not match column type for: " + name.toString();
+        continue;
+      }
+
+      columnType.set(*member, value);
+    }
+    else
+      collection->addMember(columnType.make(name, value));
+  }
+}
+
+//##################################################################################################
+const uint8_t* CollectionBatch::typedValues(const tp_utils::StringID& name,
+                                            const tp_utils::StringID& type,
+                                            size_t elementSize) const
+{
+  auto c = column(name);
+  if(!c || c->type != type || c->elementSize != elementSize)
+    return nullptr;
+
+  return c->values.data();
+}
+
+}
@@ -0,0 +1,267 @@
+#include "tp_data/CollectionCache.h"
+#include "tp_data/Collection.h"
+#include "tp_data/CollectionFactory.h"
+#include "tp_data/SharedBuffer.h"
+
+#include <future>
+#include <stdexcept>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace tp_data
+{
+
+namespace
+{
+//##################################################################################################
+struct LoadResult
+{
+  std::shared_ptr<const Collection> collection;
+  std::string error;
+};
+
+//##################################################################################################
+//! A load that is in progress, other requests for the same key wait on the future.
+struct PendingLoad
+{
+  std::promise<LoadResult> promise;
+  std::shared_future<LoadResult> future{promise.get_future().share()};
+};
+
+//##################################################################################################
+struct Entry
+{
+  std::string key;
+  std::shared_ptr<const Collection> collection;
+  size_t bytes;
+};
+}
+
+//##################################################################################################
+struct CollectionCache::Private
+{
+  const CollectionFactory* collectionFactory;
+  size_t byteBudget;
+
+  mutable std::mutex mutex;
+
+  //Most recently used at the front.
+  std::list<Entry> entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  std::unordered_map<std::string, std::shared_ptr<PendingLoad>> pending;
+
+  size_t bytes{0};
+  CollectionCacheStats stats;
+
+  //################################################################################################
+  Private(const CollectionFactory* collectionFactory_, size_t byteBudget_):
+    collectionFactory(collectionFactory_),
+    byteBudget(byteBudget_)
+  {
+
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  void erase(std::list<Entry>::iterator i)
+  {
+    bytes -= i->bytes;
+    index.erase(i->key);
+    entries.erase(i);
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  void evict()
+  {
+    while(bytes>byteBudget && !entries.empty())
+    {
+      erase(std::prev(entries.end()));
+      stats.evictions++;
+    }
+  }
+};
+
+//##################################################################################################
+CollectionCache::CollectionCache(const CollectionFactory* collectionFactory, size_t byteBudget):
+  d(new Private(collectionFactory, byteBudget))
+{
+
+}
+
+//##################################################################################################
+CollectionCache::~CollectionCache()
+{
+  delete d;
+}
+
+//##################################################################################################
+void CollectionCache::setByteBudget(size_t byteBudget)
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  d->byteBudget = byteBudget;
+  d->evict();
+}
+
+//##################################################################################################
+size_t CollectionCache::byteBudget() const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  return d->byteBudget;
+}
+
+//##################################################################################################
+std::shared_ptr<const Collection> CollectionCache::loadFromPath(std::string& error, const std::string& path)
+{
+  return get(error, path, [&](std::string& error, Collection& output)
+  {
+    d->collectionFactory->loadFromPath(error, path, output);
+  });
+}
+
+//##################################################################################################
+std::shared_ptr<const Collection> CollectionCache::loadFromData(std::string& error,
+                                                                const std::string& key,
+                                                                const std::string& data)
+{
+  return get(error, key, [&](std::string& error, Collection& output)
+  {
+    d->collectionFactory->loadFromData(error, data, output);
+  });
+}
+
+//##################################################################################################
+std::shared_ptr<const Collection> CollectionCache::loadFromData(std::string& error,
+                                                                const std::string& key,
+                                                                const SharedBuffer& data)
+{
+  return get(error, key, [&](std::string& error, Collection& output)
+  {
+    d->collectionFactory->loadFromData(error, data, output);
+  });
+}
+
+//##################################################################################################
+std::shared_ptr<const Collection> CollectionCache::get(std::string& error,
+                                                       const std::string& key,
+                                                       const LoadFunction& load)
+{
+  std::shared_ptr<PendingLoad> pendingLoad;
+  {
+    std::unique_lock<std::mutex> lock(d->mutex);
+
+    if(auto i = d->index.find(key); i!=d->index.end())
+    {
+      d->entries.splice(d->entries.begin(), d->entries, i->second);
+      d->stats.hits++;
+      return i->second->collection;
+    }
+
+    if(auto i = d->pending.find(key); i!=d->pending.end())
+    {
+      auto future = i->second->future;
+      d->stats.coalesced++;
+      lock.unlock();
+
+      const auto& result = future.get();
+      if(!result.error.empty())
+        error = result.error;
+      return result.collection;
+    }
+
+    d->stats.misses++;
+    pendingLoad = std::make_shared<PendingLoad>();
+    d->pending[key] = pendingLoad;
+  }
+
+  LoadResult result;
+  {
+    auto collection = std::make_shared<Collection>();
+
+    //An exception must not escape before the pending load is removed and the waiters are released.
+    try
+    {
+      load(result.error, *collection);
+    }
+    catch(const std::exception& exception)
+    {
+      result.error = std::string("Exception thrown while loading collection: ") + exception.what();
+    }
+    catch(...)
+    {
+      result.error = "Exception thrown while loading collection.";
+    }
+
+    if(result.error.empty())
+      result.collection = std::move(collection);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(d->mutex);
+
+    //If remove() or clear() was called while loading the result is not cached.
+    if(auto i = d->pending.find(key); i!=d->pending.end() && i->second==pendingLoad)
+    {
+      d->pending.erase(i);
+
+      if(result.collection)
+      {
+        size_t bytes = result.collection->memoryUsage();
+        if(bytes<=d->byteBudget)
+        {
+          d->entries.push_front({key, result.collection, bytes});
+          d->index[key] = d->entries.begin();
+          d->bytes += bytes;
+          d->evict();
+        }
+      }
+    }
+  }
+
+  if(!result.error.empty())
+    error = result.error;
+
+  auto collection = result.collection;
+  pendingLoad->promise.set_value(std::move(result));
+  return collection;
+}
+
+//##################################################################################################
+std::shared_ptr<const Collection> CollectionCache::find(const std::string& key) const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  auto i = d->index.find(key);
+  return (i!=d->index.end())?i->second->collection:std::shared_ptr<const Collection>();
+}
+
+//##################################################################################################
+void CollectionCache::remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  d->pending.erase(key);
+  if(auto i = d->index.find(key); i!=d->index.end())
+    d->erase(i->second);
+}
+
+//##################################################################################################
+void CollectionCache::clear()
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  d->pending.clear();
+  d->entries.clear();
+  d->index.clear();
+  d->bytes = 0;
+}
+
+//##################################################################################################
+CollectionCacheStats CollectionCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  CollectionCacheStats stats = d->stats;
+  stats.entries = d->entries.size();
+  stats.bytes = d->bytes;
+  return stats;
+}
+
+}
@@ -0,0 +1,34 @@
+#include "tp_data/CollectionDiff.h"
+
+namespace tp_data
+{
+
+namespace
+{
+//##################################################################################################
+nlohmann::json namesToJSON(const std::vector<tp_utils::StringID>& names)
+{
+  nlohmann::json j = nlohmann::json::array();
+  for(const auto& name : names)
+    j.push_back(name.toString());
+  return j;
+}
+}
+
+//##################################################################################################
+bool CollectionDiff::empty() const
+{
+  return added.empty() && removed.empty() && changed.empty();
+}
+
+//##################################################################################################
+nlohmann::json CollectionDiff::toJSON() const
+{
+  nlohmann::json j;
+  j["added"]   = namesToJSON(added);
+  j["removed"] = namesToJSON(removed);
+  j["changed"] = namesToJSON(changed);
+  return j;
+}
+
+}
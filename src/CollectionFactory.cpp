@@ -1,7 +1,15 @@
 #include "tp_data/CollectionFactory.h"
 #include "tp_data/AbstractMember.h"
 #include "tp_data/AbstractMemberFactory.h"
+#include "tp_data/BinaryDelta.h"
+#include "tp_data/BlobFormat.h"
 #include "tp_data/Collection.h"
+#include "tp_data/CollectionDiff.h"
+#include "tp_data/CollectionInfo.h"
+#include "tp_data/ContentHash.h"
+#include "tp_data/FactoryCounters.h"
+#include "tp_data/LoadFilter.h"
+#include "tp_data/Tracing.h"
 
 #include "tp_utils/DebugUtils.h"
 #include "tp_utils/FileUtils.h"
@@ -10,91 +18,418 @@
 
 #include "json.hpp"
 
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
 #include <memory>
+#include <mutex>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace tp_data
 {
 
 namespace
 {
+using blob::addPart;
+using blob::beginPart;
+using blob::endPart;
+using blob::addAlignmentPart;
+using blob::parsePart;
 
 //##################################################################################################
-void addPart(std::string& output, const std::string& key, const std::string& data)
+size_t batchBytes(const std::vector<std::string_view>& data)
 {
-  auto keyLen = uint8_t(key.size());
-  auto partLen = keyLen + data.size() + 5;
-
-  output.reserve(output.size()+partLen);
-  output.push_back(static_cast<char>(keyLen));
-  output.append(key);
-
-  output.push_back(static_cast<char>(data.size() >>  0));
-  output.push_back(static_cast<char>(data.size() >>  8));
-  output.push_back(static_cast<char>(data.size() >> 16));
-  output.push_back(static_cast<char>(data.size() >> 24));
-
-  output.append(data);
+  size_t bytes=0;
+  for(const auto& memberData : data)
+    bytes += memberData.size();
+  return bytes;
 }
 
 //##################################################################################################
-bool parsePart(std::string& error, const std::string& input, int& startFrom, std::string& key, std::string& data)
+//! Parse a blob and call loadMember(factory, dataOffset, dataLen) for each member to load.
+/*!
+Members whose factory batches are instead grouped by type and loaded with loadBatch() once the
+whole blob has been parsed. The members are added to the collection in the order they were saved.
+*/
+template<typename LoadMember>
+void loadFromDataImpl(std::string& error,
+                      const CollectionFactory& collectionFactory,
+                      const char* data,
+                      size_t dataSize,
+                      Collection& output,
+                      const LoadFilter& filter,
+                      const LoadMember& loadMember)
 {
-  auto ok = [&input, &startFrom, &error](int count)
+  if(dataSize==0)
+  {
+    error = "Data is empty.";
+    return;
+  }
+
+  bool headerSet=false;
+
+  //These hold the details of the current member that we are parsing, once complete addMember()
+  //will be called to add the member to the collection.
+  std::string currentMemberName;
+  int64_t currentMemberTimestamp{0};
+  std::string currentMemberType;
+  size_t currentMemberDataOffset{0};
+
+  //Members of the same type are often saved together so cache the last factory found.
+  std::string lastMemberType;
+  const AbstractMemberFactory* lastFactory{nullptr};
+  size_t currentMemberDataLen{0};
+
+  //Loaded members in blob order, members that are waiting for loadBatch() are null.
+  std::vector<std::shared_ptr<AbstractMember>> loaded;
+
+  struct Batch
   {
-    bool ok = ((startFrom+count)<=int(input.size()));
-    if(!ok)
-      error = "Unexpectedly reached end of buffer.";
-    return ok;
+    std::vector<std::string_view> data;
+    std::vector<size_t> slots;
+    std::vector<std::string> names;
+    std::vector<int64_t> timestamps;
   };
+  std::unordered_map<const AbstractMemberFactory*, Batch> batches;
 
-  //- Read a single unsigned byte that is the key length -------------------------------------------
-  if(int(input.size())<=startFrom)
-    return false;
+  auto addLoaded = [&]()
+  {
+    for(auto& member : loaded)
+      if(member)
+        output.addMember(member);
+  };
 
-  auto keyLen = static_cast<uint8_t>(input.at(size_t(startFrom)));
-  startFrom++;
+  auto clearCurrentMember = [&]()
+  {
+    currentMemberType.clear();
+    currentMemberName.clear();
+    currentMemberTimestamp = 0;
+    currentMemberDataOffset = 0;
+    currentMemberDataLen = 0;
+  };
 
+  auto addMember = [&]()
+  {
+    if(currentMemberType.empty())
+      return true;
 
-  //- Read the key ---------------------------------------------------------------------------------
-  if(!ok(keyLen))
-    return false;
+    headerSet = true;
+
+    //Rejected members are skipped before their data is touched.
+    if(!filter.accepts(currentMemberName, currentMemberType, currentMemberTimestamp))
+    {
+      clearCurrentMember();
+      return true;
+    }
+
+    if(!lastFactory || currentMemberType != lastMemberType)
+    {
+      lastFactory = collectionFactory.memberFactoryByName(currentMemberType);
+      lastMemberType = currentMemberType;
+    }
+
+    auto factory=lastFactory;
+
+    if(!factory)
+    {
+      tpWarning() << "Failed to find member factory for: " << currentMemberType;
+      error = "Failed to find member factory for: " + currentMemberType;
+      return false;
+    }
+
+    if(factory->batchesMembers())
+    {
+      auto& batch = batches[factory];
+      batch.data.emplace_back(data+currentMemberDataOffset, currentMemberDataLen);
+      batch.slots.push_back(loaded.size());
+      batch.names.push_back(currentMemberName);
+      batch.timestamps.push_back(currentMemberTimestamp);
+      loaded.emplace_back();
+    }
+    else
+    {
+      TP_DATA_TRACE_MEMBER_SCOPE(trace, "load member", currentMemberName, currentMemberType);
+      TP_DATA_TRACE_BYTES(trace, currentMemberDataLen);
+      auto member = loadMember(factory, currentMemberDataOffset, currentMemberDataLen);
+
+      if(!member || !error.empty())
+      {
+        tpWarning() << "Valid: " << (member!=nullptr);
+        tpWarning() << "Error: " << error;
+
+        tpWarning() << "Failed to load a member, name: " << currentMemberName << " type: " << currentMemberType;
+        error = "Failed to load a member, name: " + currentMemberName + " type: " + currentMemberType;
+        return false;
+      }
+
+      member->setName(currentMemberName);
+      member->setTimestampMS(currentMemberTimestamp);
+      member->setTypeIndex(factory->typeIndex());
+      loaded.push_back(std::move(member));
+    }
+
+    clearCurrentMember();
+    return true;
+  };
+
+  auto flushState = [&]()
+  {
+    return addMember();
+  };
+
+  size_t startFrom = 0;
+  std::string key;
+  size_t partOffset=0;
+  size_t partLen=0;
+  while(parsePart(error, data, dataSize, startFrom, key, partOffset, partLen))
+  {
+    auto partData = [&]{return std::string_view(data+partOffset, partLen);};
+    auto partInt64 = [&]
+    {
+      int64_t value{0};
+      std::from_chars(data+partOffset, data+partOffset+partLen, value);
+      return value;
+    };
+
+    if(key == "member")
+    {
+      if(!flushState())
+      {
+        error = "Flush state error.";
+        addLoaded();
+        return;
+      }
+
+      currentMemberName = partData();
+    }
+
+    else if(key == "type")
+    {
+      if(!currentMemberName.empty())
+        currentMemberType = partData();
+    }
+
+    else if(key == "timestamp")
+    {
+      if(!currentMemberName.empty())
+        currentMemberTimestamp = partInt64();
+      else if(!headerSet)
+        output.setTimestampMS(partInt64());
+      else
+        tpWarning() << "Unexpected timestamp.";
+    }
+
+    else if(key == "data")
+    {
+      if(!currentMemberName.empty())
+      {
+        currentMemberDataOffset = partOffset;
+        currentMemberDataLen = partLen;
+      }
+    }
+
+    else if(key == "name")
+    {
+      if(!headerSet)
+        output.setName(std::string(partData()));
+    }
+  }
 
-  key.resize(keyLen);
-  if(keyLen>0)
+  if(!flushState())
   {
-    memcpy(&key[0], input.data()+startFrom, keyLen);
-    startFrom += int(keyLen);
+    error = "Final flush state error.";
+    addLoaded();
+    return;
+  }
+
+  for(const auto& i : batches)
+  {
+    const auto& batch = i.second;
+    std::vector<std::shared_ptr<AbstractMember>> members;
+    TP_DATA_TRACE_MEMBER_SCOPE(trace, "load batch", std::string(), i.first->type().keyString());
+    TP_DATA_TRACE_BYTES(trace, batchBytes(batch.data));
+    CountedScope scope(collectionFactory.counters(), i.first->typeIndex(), CountedOperation::Load);
+    i.first->loadBatch(error, batch.data, members);
+    scope.stop(batch.data.size(), batchBytes(batch.data), members.size() != batch.data.size() || !error.empty());
+
+    if(members.size() != batch.data.size() || !error.empty())
+    {
+      tpWarning() << "Failed to load a batch of members, type: " << i.first->type().toString();
+      error = "Failed to load a batch of members, type: " + i.first->type().toString();
+      break;
+    }
+
+    for(size_t m=0; m<members.size(); m++)
+    {
+      auto& member = members.at(m);
+      member->setName(batch.names.at(m));
+      member->setTimestampMS(batch.timestamps.at(m));
+      member->setTypeIndex(i.first->typeIndex());
+      loaded.at(batch.slots.at(m)) = std::move(member);
+    }
   }
 
+  addLoaded();
+}
+
+//##################################################################################################
+bool isAbsolutePath(const std::string& path)
+{
+  return (!path.empty() && (path.front()=='/' || path.front()=='\\')) || (path.size()>1 && path.at(1)==':');
+}
+
+//##################################################################################################
+//! The path of a member file, files in an object store are listed by "object" in the index.
+std::string memberFilePath(const std::string& path, const nlohmann::json& j)
+{
+  if(auto object = TPJSONString(j, "object"); !object.empty())
+    return isAbsolutePath(object)?object:(path + "/" + object);
+  return path + "/" + TPJSONString(j, "filename");
+}
+
+//##################################################################################################
+//! A temporary file name next to filePath, used to write a file before renaming it into place.
+/*!
+The name includes the process id and a counter so that it is unique across processes and calls,
+writers that share a directory never write to the same temporary file.
+*/
+std::string tmpFilePath(const std::string& filePath)
+{
+  static std::atomic<uint64_t> counter{0};
+#ifdef _WIN32
+  auto pid = _getpid();
+#else
+  auto pid = getpid();
+#endif
+  return filePath + ".tmp" + std::to_string(pid) + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
 
-  //- Read a 4 byte unsigned little endian number that is the length of the data -------------------
-  if(!ok(4))
+//##################################################################################################
+//! Replace a member file by writing a temporary file and renaming it over the old one.
+/*!
+Member files may be memory mapped by loadFromPath(), truncating and rewriting them in place would
+pull the data out from under the mapping. Renaming replaces the directory entry so existing
+mappings keep the old file.
+*/
+bool replaceFile(const std::string& filePath, const std::string& data)
+{
+  std::string tmpPath = tmpFilePath(filePath);
+  if(!tp_utils::writeBinaryFile(tmpPath, data))
+  {
+    std::remove(tmpPath.c_str());
     return false;
+  }
 
-  uint32_t dataLen = 0;
-  for(uint32_t i=0; i<4; i++)
+  if(std::rename(tmpPath.c_str(), filePath.c_str())!=0)
   {
-    auto p = uint8_t(input.at(size_t(startFrom)));
-    startFrom++;
-    dataLen |= (uint32_t(p) << (8*i));
+    //On Windows rename does not replace an existing file.
+    std::remove(filePath.c_str());
+    if(std::rename(tmpPath.c_str(), filePath.c_str())!=0)
+    {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
   }
 
+  return true;
+}
+
+//##################################################################################################
+//! Write an object to the store if it is not already there.
+/*!
+Objects are written to a temporary file and renamed into place so that a reader or another writer
+never sees a partial object.
+*/
+bool writeObject(const std::string& filePath, const std::string& data)
+{
+  if(tp_utils::exists(filePath))
+    return true;
 
-  //- Read the data --------------------------------------------------------------------------------
-  if(!ok(int(dataLen)))
+  std::string tmpPath = tmpFilePath(filePath);
+  if(!tp_utils::writeBinaryFile(tmpPath, data))
     return false;
 
-  data.resize(dataLen);
-  if(dataLen>0)
+  if(std::rename(tmpPath.c_str(), filePath.c_str())!=0)
   {
-    memcpy(&data[0], input.data()+startFrom, dataLen);
-    startFrom += int(dataLen);
+    std::remove(tmpPath.c_str());
+    return tp_utils::exists(filePath);
   }
 
   return true;
 }
 
+//##################################################################################################
+//! Parse the header parts of a blob, the data parts are only measured.
+void listFromDataImpl(std::string& error, const char* data, size_t dataSize, CollectionInfo& output)
+{
+  output = CollectionInfo();
+
+  if(dataSize==0)
+  {
+    error = "Data is empty.";
+    return;
+  }
+
+  auto toInt64 = [](const char* begin, size_t len)
+  {
+    int64_t value{0};
+    std::from_chars(begin, begin+len, value);
+    return value;
+  };
+
+  MemberInfo* current{nullptr};
+  size_t startFrom = 0;
+  std::string key;
+  size_t partOffset=0;
+  size_t partLen=0;
+  while(parsePart(error, data, dataSize, startFrom, key, partOffset, partLen))
+  {
+    if(key == "member")
+    {
+      current = &output.members.emplace_back();
+      current->name.assign(data+partOffset, partLen);
+    }
+
+    else if(key == "type")
+    {
+      if(current)
+        current->type.assign(data+partOffset, partLen);
+    }
+
+    else if(key == "timestamp")
+    {
+      if(current)
+        current->timestampMS = toInt64(data+partOffset, partLen);
+      else
+        output.timestampMS = toInt64(data+partOffset, partLen);
+    }
+
+    else if(key == "data")
+    {
+      if(current)
+        current->encodedSize = partLen;
+    }
+
+    else if(key == "name")
+    {
+      if(!current)
+        output.name.assign(data+partOffset, partLen);
+    }
+  }
+}
+
 }
 
 //##################################################################################################
@@ -102,8 +437,161 @@ struct CollectionFactory::Private
 {
   std::unordered_map<tp_utils::StringID, std::unique_ptr<AbstractMemberFactory>> memberFactories;
   bool finalized{false};
+
+  //Built by finalize, indexed by AbstractMemberFactory::typeIndex().
+  std::vector<AbstractMemberFactory*> factoryTable;
+  std::unordered_map<std::string, AbstractMemberFactory*> factoriesByName;
+
+  FactoryCounters counters;
+
+  //Asynchronous operations.
+  std::mutex asyncMutex;
+  std::condition_variable asyncCondition;
+  std::shared_ptr<AbstractExecutor> executor;
+  size_t maxInFlight{0};
+  size_t inFlight{0};
+  std::deque<std::function<void()>> queued;
+
+  //################################################################################################
+  //! Pass the task to the executor, or queue it if maxInFlight operations are running.
+  /*!
+  This never blocks so a completion callback can start the next operation.
+  */
+  void submit(std::function<void()>&& task)
+  {
+    std::vector<std::function<void()>> ready;
+    std::shared_ptr<AbstractExecutor> e;
+    {
+      std::lock_guard<std::mutex> lock(asyncMutex);
+      queued.push_back(std::move(task));
+      takeReady(ready, e);
+    }
+
+    start(e, ready);
+  }
+
+  //################################################################################################
+  //! Move queued tasks that can start now into ready.
+  // Call with asyncMutex locked.
+  void takeReady(std::vector<std::function<void()>>& ready, std::shared_ptr<AbstractExecutor>& e)
+  {
+    while(!queued.empty() && (maxInFlight==0 || inFlight<maxInFlight))
+    {
+      inFlight++;
+      ready.push_back(std::move(queued.front()));
+      queued.pop_front();
+    }
+
+    if(!ready.empty())
+    {
+      if(!executor)
+        executor = std::make_shared<ThreadPoolExecutor>();
+      e = executor;
+    }
+  }
+
+  //################################################################################################
+  //! Run tasks taken by takeReady(), each releases its slot and starts queued work when done.
+  void start(const std::shared_ptr<AbstractExecutor>& e, std::vector<std::function<void()>>& ready)
+  {
+    for(auto& task : ready)
+    {
+      e->execute([this, task=std::move(task)]
+      {
+        try
+        {
+          task();
+        }
+        catch(const std::exception& exception)
+        {
+          tpWarning() << "Exception thrown by asynchronous operation: " << exception.what();
+        }
+        catch(...)
+        {
+          tpWarning() << "Exception thrown by asynchronous operation.";
+        }
+
+        std::vector<std::function<void()>> next;
+        std::shared_ptr<AbstractExecutor> nextExecutor;
+        {
+          //Notify with the lock held so that the destructor can't delete this until we are done.
+          std::lock_guard<std::mutex> lock(asyncMutex);
+          inFlight--;
+          takeReady(next, nextExecutor);
+          asyncCondition.notify_all();
+        }
+
+        //If next is not empty inFlight is not 0 so this is still valid.
+        if(!next.empty())
+          start(nextExecutor, next);
+      });
+    }
+  }
+
+  //################################################################################################
+  void waitForAsync()
+  {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    asyncCondition.wait(lock, [&]{return inFlight==0 && queued.empty();});
+  }
 };
 
+namespace
+{
+//##################################################################################################
+//! Discard the result of a cancelled operation and the partial result of a failed one.
+template<typename Result>
+void finishAsync(Result& result, const CancellationToken& cancellationToken)
+{
+  if(cancellationToken.cancelled())
+  {
+    result = Result();
+    result.error = "Cancelled.";
+    result.cancelled = true;
+  }
+  else if(!result.error.empty())
+  {
+    auto error = std::move(result.error);
+    result = Result();
+    result.error = std::move(error);
+  }
+}
+
+//##################################################################################################
+//! Run an operation unless it has been cancelled, an exception is returned as an error.
+template<typename Result, typename Operation>
+void runAsync(Result& result, const CancellationToken& cancellationToken, const Operation& operation)
+{
+  if(!cancellationToken.cancelled())
+  {
+    try
+    {
+      operation();
+    }
+    catch(const std::exception& exception)
+    {
+      result.error = std::string("Exception: ") + exception.what();
+    }
+    catch(...)
+    {
+      result.error = "Unknown exception.";
+    }
+  }
+
+  finishAsync(result, cancellationToken);
+}
+
+//##################################################################################################
+//! Returns a callback that fulfills a future.
+template<typename Result>
+std::function<void(Result&&)> promiseCallback(std::future<Result>& future)
+{
+  auto promise = std::make_shared<std::promise<Result>>();
+  future = promise->get_future();
+  return [promise](Result&& result){promise->set_value(std::move(result));};
+}
+}
+
 //##################################################################################################
 CollectionFactory::CollectionFactory():
   d(new Private())
@@ -114,6 +602,7 @@ CollectionFactory::CollectionFactory():
 //##################################################################################################
 CollectionFactory::~CollectionFactory()
 {
+  d->waitForAsync();
   delete d;
 }
 
@@ -134,6 +623,29 @@ void CollectionFactory::finalize()
   }
 
   d->finalized = true;
+
+  //Sort by name so that type indexes are stable between runs.
+  d->factoryTable.reserve(d->memberFactories.size());
+  for(const auto& i : d->memberFactories)
+    d->factoryTable.push_back(i.second.get());
+
+  std::sort(d->factoryTable.begin(), d->factoryTable.end(), [](const auto a, const auto b)
+  {
+    return a->type().keyString() < b->type().keyString();
+  });
+
+  for(size_t i=0; i<d->factoryTable.size(); i++)
+  {
+    auto factory = d->factoryTable.at(i);
+    factory->m_typeIndex = i;
+    d->factoriesByName[factory->type().keyString()] = factory;
+  }
+
+  std::vector<tp_utils::StringID> types;
+  types.reserve(d->factoryTable.size());
+  for(const auto factory : d->factoryTable)
+    types.push_back(factory->type());
+  d->counters.setTypes(types);
 }
 
 //##################################################################################################
@@ -157,18 +669,60 @@ const AbstractMemberFactory* CollectionFactory::memberFactory(const tp_utils::St
   return (i != d->memberFactories.end())?(i->second.get()):nullptr;
 }
 
+//##################################################################################################
+const AbstractMemberFactory* CollectionFactory::memberFactory(const AbstractMember& member) const
+{
+  if(auto i=member.typeIndex(); i<d->factoryTable.size())
+    if(auto factory=d->factoryTable[i]; factory->type() == member.type())
+      return factory;
+
+  auto factory = memberFactory(member.type());
+  if(factory)
+    member.setTypeIndex(factory->typeIndex());
+  return factory;
+}
+
+//##################################################################################################
+const AbstractMemberFactory* CollectionFactory::memberFactoryByName(const std::string& type) const
+{
+  if(!d->finalized)
+    return memberFactory(type);
+
+  auto i = d->factoriesByName.find(type);
+  return (i != d->factoriesByName.end())?i->second:nullptr;
+}
+
+//##################################################################################################
+const AbstractMemberFactory* CollectionFactory::memberFactoryByIndex(size_t typeIndex) const
+{
+  return (typeIndex<d->factoryTable.size())?d->factoryTable[typeIndex]:nullptr;
+}
+
 //##################################################################################################
 const std::unordered_map<tp_utils::StringID, std::unique_ptr<AbstractMemberFactory>>& CollectionFactory::memberFactories() const
 {
   return d->memberFactories;
 }
 
+//##################################################################################################
+FactoryCounters& CollectionFactory::counters()
+{
+  return d->counters;
+}
+
+//##################################################################################################
+const FactoryCounters& CollectionFactory::counters() const
+{
+  return d->counters;
+}
+
 //##################################################################################################
 void CollectionFactory::cloneAppend(std::string& error,
                                     const Collection& collection,
                                     Collection& output,
                                     const std::vector<std::string>& subset) const
 {
+  TP_DATA_TRACE_SCOPE(trace, "cloneAppend");
   for(const auto& member : collection.members())
   {
     if(!subset.empty() && !tpContains(subset, member->name()))
@@ -176,14 +730,17 @@ void CollectionFactory::cloneAppend(std::string& error,
 
     const tp_utils::StringID& type = member->type();
 
-    auto factory=memberFactory(type);
+    auto factory=memberFactory(*member);
     if(!factory)
     {
       error = "Failed to find factory for member type: " + type.toString();
       continue;
     }
 
+    TP_DATA_TRACE_MEMBER_SCOPE(memberTrace, "clone member", member->name(), type);
+    CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Clone);
     auto newMember = factory->clone(error, *member);
+    scope.stop(1, 0, !newMember);
     if(!newMember)
     {
       error = "Failed to clone member of type: " + type.toString();
@@ -202,115 +759,50 @@ void CollectionFactory::loadFromData(std::string& error,
                                      Collection& output,
                                      const std::vector<std::string>& subset) const
 {
-  if(data.empty())
-  {
-    error = "Data is empty.";
-    return;
-  }
-
-  bool headerSet=false;
-
-  //These hold the details of the current member that we are parsing, once complete addMember()
-  //will be called to add the member to the collection.
-  std::string currentMemberName;
-  int64_t currentMemberTimestamp{0};
-  std::string currentMemberType;
-  std::string currentMemberData;
+  loadFromData(error, data, output, LoadFilter(subset));
+}
 
-  auto addMember = [&, this]()
+//##################################################################################################
+void CollectionFactory::loadFromData(std::string& error,
+                                     const std::string& data,
+                                     Collection& output,
+                                     const LoadFilter& filter) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "loadFromData");
+  TP_DATA_TRACE_BYTES(trace, data.size());
+  loadFromDataImpl(error, *this, data.data(), data.size(), output, filter, [&](const AbstractMemberFactory* factory, size_t offset, size_t len)
   {
-    if(currentMemberType.empty())
-      return true;
-
-    if(!subset.empty() && !tpContains(subset, currentMemberName))
-      return true;
-
-    headerSet = true;
-
-    auto factory=memberFactory(currentMemberType);
-
-    if(!factory)
-    {
-      tpWarning() << "Failed to find member factory for: " << currentMemberType;
-      error = "Failed to find member factory for: " + currentMemberType;
-      return false;
-    }
-
-    auto member = factory->load(error, currentMemberData);
-
-    if(!member || !error.empty())
-    {
-      tpWarning() << "Valid: " << (member!=nullptr);
-      tpWarning() << "Error: " << error;
-
-      tpWarning() << "Failed to load a member, name: " << currentMemberName << " type: " << currentMemberType;
-      error = "Failed to load a member, name: " + currentMemberName + " type: " + currentMemberType;
-      return false;
-    }
-
-    member->setName(currentMemberName);
-    member->setTimestampMS(currentMemberTimestamp);
-    output.addMember(member);
-
-    currentMemberType.clear();
-    currentMemberName.clear();
-    currentMemberTimestamp = 0;
-    currentMemberData.clear();
-    return true;
-  };
+    CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Load);
+    auto member = factory->loadView(error, std::string_view(data).substr(offset, len));
+    scope.stop(1, len, !member || !error.empty());
+    return member;
+  });
+}
 
-  auto flushState = [&]()
-  {
-    return addMember();
-  };
+//##################################################################################################
+void CollectionFactory::loadFromData(std::string& error,
+                                     const SharedBuffer& data,
+                                     Collection& output,
+                                     const std::vector<std::string>& subset) const
+{
+  loadFromData(error, data, output, LoadFilter(subset));
+}
 
-  int startFrom = 0;
-  std::string key;
-  std::string partData;
-  while(parsePart(error, data, startFrom, key, partData))
+//##################################################################################################
+void CollectionFactory::loadFromData(std::string& error,
+                                     const SharedBuffer& data,
+                                     Collection& output,
+                                     const LoadFilter& filter) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "loadFromData");
+  TP_DATA_TRACE_BYTES(trace, data.size());
+  loadFromDataImpl(error, *this, data.data(), data.size(), output, filter, [&](const AbstractMemberFactory* factory, size_t offset, size_t len)
   {
-    if(key == "member")
-    {
-      if(!flushState())
-      {
-        error = "Flush state error.";
-        return;
-      }
-
-      currentMemberName = partData;
-    }
-
-    else if(key == "type")
-    {
-      if(!currentMemberName.empty())
-        currentMemberType = partData;
-    }
-
-    else if(key == "timestamp")
-    {
-      if(!currentMemberName.empty())
-        currentMemberTimestamp = std::stoll(partData);
-      else if(!headerSet)
-        output.setTimestampMS(std::stoll(partData));
-      else
-        tpWarning() << "Unexpected timestamp.";
-    }
-
-    else if(key == "data")
-    {
-      if(!currentMemberName.empty())
-        currentMemberData = partData;
-    }
-
-    else if(key == "name")
-    {
-      if(!headerSet)
-        output.setName(partData);
-    }
-  }
-
-  if(!flushState())
-    error = "Final flush state error.";
+    CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Load);
+    auto member = factory->loadShared(error, data.slice(offset, len));
+    scope.stop(1, len, !member || !error.empty());
+    return member;
+  });
 }
 
 //##################################################################################################
@@ -319,6 +811,16 @@ void CollectionFactory::loadFromPath(std::string& error,
                                      Collection& output,
                                      const std::vector<std::string>& subset) const
 {
+  loadFromPath(error, path, output, LoadFilter(subset));
+}
+
+//##################################################################################################
+void CollectionFactory::loadFromPath(std::string& error,
+                                     const std::string& path,
+                                     Collection& output,
+                                     const LoadFilter& filter) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "loadFromPath");
   nlohmann::json j = tp_utils::readJSONFile(path + "/index.json");
 
   output.setName(TPJSONString(j, "name"));
@@ -328,21 +830,21 @@ void CollectionFactory::loadFromPath(std::string& error,
   {
     for(const auto& jj : *i)
     {
-      auto name = TPJSONString(jj, "name");
-      if(!subset.empty() && !tpContains(subset, name))
-        continue;
-
-      auto filename  = TPJSONString(jj, "filename");
+      auto name      = TPJSONString(jj, "name");
       auto type      = TPJSONString(jj, "type");
       auto timestamp = TPJSONInt64T(jj, "timestamp");
 
+      //Rejected members are skipped before their files are read.
+      if(!filter.accepts(name, type, timestamp))
+        continue;
+
       if(type.empty())
       {
         error = "Empty member type!";
         return;
       }
 
-      auto factory = memberFactory(type);
+      auto factory = memberFactoryByName(type);
 
       if(!factory)
       {
@@ -352,10 +854,30 @@ void CollectionFactory::loadFromPath(std::string& error,
         return;
       }
 
-      std::string memberPath = path;
-      memberPath += "/";
-      memberPath += filename;
-      auto member = factory->load(error, tp_utils::readBinaryFile(memberPath));
+      std::string memberPath = memberFilePath(path, jj);
+
+      std::shared_ptr<AbstractMember> member;
+      if(factory->sharesLoadedData())
+      {
+        auto buffer = SharedBuffer::mapFile(error, memberPath);
+        if(error.empty())
+        {
+          TP_DATA_TRACE_MEMBER_SCOPE(memberTrace, "load member", name, type);
+          TP_DATA_TRACE_BYTES(memberTrace, buffer.size());
+          CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Load);
+          member = factory->loadShared(error, buffer);
+          scope.stop(1, buffer.size(), !member || !error.empty());
+        }
+      }
+      else
+      {
+        auto memberData = tp_utils::readBinaryFile(memberPath);
+        TP_DATA_TRACE_MEMBER_SCOPE(memberTrace, "load member", name, type);
+        TP_DATA_TRACE_BYTES(memberTrace, memberData.size());
+        CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Load);
+        member = factory->load(error, memberData);
+        scope.stop(1, memberData.size(), !member || !error.empty());
+      }
 
 
       if(!member || !error.empty())
@@ -374,44 +896,169 @@ void CollectionFactory::loadFromPath(std::string& error,
 
       member->setName(name);
       member->setTimestampMS(timestamp);
+      member->setTypeIndex(factory->typeIndex());
       output.addMember(member);
     }
   }
 }
 
 //##################################################################################################
-void CollectionFactory::saveToData(std::string& error, const Collection& collection, std::string& data) const
+void CollectionFactory::listFromData(std::string& error, const std::string& data, CollectionInfo& output) const
 {
-  addPart(data, "name", collection.name());
-  addPart(data, "timestamp", std::to_string(collection.timestampMS()));
+  TP_DATA_TRACE_SCOPE(trace, "listFromData");
+  listFromDataImpl(error, data.data(), data.size(), output);
+}
 
+//##################################################################################################
+void CollectionFactory::listFromData(std::string& error, const SharedBuffer& data, CollectionInfo& output) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "listFromData");
+  listFromDataImpl(error, data.data(), data.size(), output);
+}
+
+//##################################################################################################
+void CollectionFactory::listFromPath(std::string& error, const std::string& path, CollectionInfo& output) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "listFromPath");
+  output = CollectionInfo();
+
+  nlohmann::json j = tp_utils::readJSONFile(path + "/index.json");
+  if(!j.is_object())
+  {
+    error = "Failed to read index.";
+    return;
+  }
+
+  output.name = TPJSONString(j, "name");
+  output.timestampMS = TPJSONInt64T(j, "timestamp");
+
+  if(const auto i=j.find("members"); i!=j.end() && i->is_array())
+  {
+    output.members.reserve(i->size());
+    for(const auto& jj : *i)
+    {
+      auto& member = output.members.emplace_back();
+      member.name        = TPJSONString(jj, "name");
+      member.type        = TPJSONString(jj, "type");
+      member.timestampMS = TPJSONInt64T(jj, "timestamp");
+
+      if(const auto s=jj.find("size"); s!=jj.end() && s->is_number_unsigned())
+        member.encodedSize = s->get<size_t>();
+      else
+      {
+        std::ifstream file(memberFilePath(path, jj), std::ios::binary | std::ios::ate);
+        if(file)
+          member.encodedSize = size_t(file.tellg());
+      }
+    }
+  }
+}
+
+//##################################################################################################
+void CollectionFactory::saveToData(std::string& error, const Collection& collection, std::string& data) const
+{
+  std::vector<const AbstractMember*> members;
+  members.reserve(collection.members().size());
   for(const auto& member : collection.members())
+    members.push_back(member.get());
+
+  saveToData(error, collection.name(), collection.timestampMS(), members, data);
+}
+
+//##################################################################################################
+void CollectionFactory::saveToData(std::string& error,
+                                   const std::string& name,
+                                   int64_t timestampMS,
+                                   const std::vector<const AbstractMember*>& members,
+                                   std::string& data) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "saveToData");
+
+  addPart(data, "name", name);
+  addPart(data, "timestamp", std::to_string(timestampMS));
+
+  //-- Find the factory for each member and group the members of factories that batch -------------
+  struct Batch
   {
-    const tp_utils::StringID& type = member->type();
+    std::vector<const AbstractMember*> members;
+    std::string data;
+    std::vector<size_t> ends;
+    size_t next{0};
+  };
+
+  std::vector<const AbstractMemberFactory*> factories;
+  factories.reserve(members.size());
+  std::unordered_map<const AbstractMemberFactory*, Batch> batches;
+  for(const auto& member : members)
+  {
+    auto factory=memberFactory(*member);
 
-    auto factory=memberFactory(type);
+    if(!factory)
+    {
+      error = "Failed to find factory for member type: " + member->type().toString();
+      return;
+    }
+
+    factories.push_back(factory);
+    if(factory->batchesMembers())
+      batches[factory].members.push_back(member);
+  }
+
+  for(auto& i : batches)
+  {
+    auto& batch = i.second;
+    TP_DATA_TRACE_MEMBER_SCOPE(batchTrace, "save batch", std::string(), i.first->type().keyString());
+    CountedScope scope(d->counters, i.first->typeIndex(), CountedOperation::Save);
+    i.first->saveBatch(error, batch.members, batch.data, batch.ends);
+    scope.stop(batch.members.size(), batch.data.size(), !error.empty() || batch.ends.size() != batch.members.size());
+    TP_DATA_TRACE_BYTES(batchTrace, batch.data.size());
+    if(!error.empty() || batch.ends.size() != batch.members.size())
+    {
+      error += "Failed to serialize batch of type:" + i.first->type().toString();
+      return;
+    }
+  }
+
+  //-- Write the members in collection order -------------------------------------------------------
+  for(size_t m=0; m<members.size(); m++)
+  {
+    const auto& member = members.at(m);
+    auto factory = factories.at(m);
+
+    //The member is saved straight into the output, if it fails the partial member is removed.
+    size_t memberStart = data.size();
+    addPart(data, "member", member->name().toString());
+    addPart(data, "type", member->type().keyString());
+    addPart(data, "timestamp", std::to_string(member->timestampMS()));
+    addAlignmentPart(data, factory->dataAlignment());
 
-    if(!factory)
+    size_t lengthOffset = beginPart(data, "data");
+    if(auto i=batches.find(factory); i!=batches.end())
     {
-      error = "Failed to find factory for member type: " + type.toString();
-      return;
+      auto& batch = i->second;
+      size_t begin = (batch.next==0)?0:batch.ends.at(batch.next-1);
+      data.append(batch.data, begin, batch.ends.at(batch.next)-begin);
+      batch.next++;
+    }
+    else
+    {
+      TP_DATA_TRACE_MEMBER_SCOPE(memberTrace, "save member", member->name(), member->type());
+      CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Save);
+      size_t before = data.size();
+      factory->saveAppend(error, *member, data);
+      scope.stop(1, data.size()-before, !error.empty());
+      TP_DATA_TRACE_BYTES(memberTrace, data.size()-before);
     }
 
-    std::string timestamp = std::to_string(member->timestampMS());
-    std::string memberData;
-    factory->save(error, *member, memberData);
-
-    if(!error.empty())
+    if(!error.empty() || !endPart(error, data, lengthOffset))
     {
-      error += "Failed to serialize name:" + member->name().toString() + " type:" + type.toString();
+      data.resize(memberStart);
+      error += "Failed to serialize name:" + member->name().toString() + " type:" + member->type().toString();
       return;
     }
-
-    addPart(data, "member", member->name().toString());
-    addPart(data, "type", type.toString());
-    addPart(data, "timestamp", timestamp);
-    addPart(data, "data", memberData);
   }
+
+  TP_DATA_TRACE_BYTES(trace, data.size());
 }
 
 //##################################################################################################
@@ -420,6 +1067,17 @@ void CollectionFactory::saveToPath(std::string& error,
                                    const std::string& path,
                                    bool append) const
 {
+  saveToObjectStore(error, collection, path, std::string(), append);
+}
+
+//##################################################################################################
+void CollectionFactory::saveToObjectStore(std::string& error,
+                                          const Collection& collection,
+                                          const std::string& path,
+                                          const std::string& objectStorePath,
+                                          bool append) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "saveToPath");
 #if 0
   tpWarning() << "CollectionFactory::saveToPath Not supported on this platform!";
   TP_UNUSED(error);
@@ -459,23 +1117,32 @@ void CollectionFactory::saveToPath(std::string& error,
     return;
   }
 
+  //The store path as written to the index and the path that we write objects to.
+  std::string objectStoreIndexPath = objectStorePath;
+  std::string objectStoreFilePath = isAbsolutePath(objectStorePath)?objectStorePath:(path + "/" + objectStorePath);
+
   //-- Save each member to its own file ------------------------------------------------------------
   std::vector<tp_utils::StringID> newMembers;
   newMembers.reserve(collection.members().size());
+  std::string data;
   for(const auto& member : collection.members())
   {
     const tp_utils::StringID& name = member->name();
     const tp_utils::StringID& type = member->type();
 
-    auto factory=memberFactory(type);
+    auto factory=memberFactory(*member);
     if(!factory)
     {
       error = "Failed to find factory for member type: " + type.toString();
       return;
     }
 
-    std::string data;
-    factory->save(error, *member, data);
+    data.clear();
+    TP_DATA_TRACE_MEMBER_SCOPE(memberTrace, "save member", name, type);
+    CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Save);
+    factory->saveAppend(error, *member, data);
+    scope.stop(1, data.size(), !error.empty());
+    TP_DATA_TRACE_BYTES(memberTrace, data.size());
 
     if(!error.empty())
     {
@@ -483,24 +1150,50 @@ void CollectionFactory::saveToPath(std::string& error,
       return;
     }
 
-    std::string filename = name.toString();
-    filename += ".";
-    filename += factory->extension();
+    nlohmann::json j;
+    j["name"] = name.toString();
+    j["type"] = type.toString();
+    j["timestamp"] = member->timestampMS();
+    j["size"] = data.size();
 
-    std::string filePath = path;
-    filePath += "/";
-    filePath += filename;
+    if(objectStorePath.empty())
+    {
+      std::string filename = name.toString();
+      filename += ".";
+      filename += factory->extension();
 
-    tp_utils::writeBinaryFile(filePath, data);
+      std::string filePath = path;
+      filePath += "/";
+      filePath += filename;
 
-    {
-      newMembers.push_back(name);
-      nlohmann::json j;
-      j["name"] = name.toString();
+      if(!replaceFile(filePath, data))
+      {
+        error = "Failed to write file for member: " + name.toString();
+        return;
+      }
       j["filename"] = filename;
-      j["type"] = type.toString();
-      membersIndex.push_back(j);
     }
+    else
+    {
+      auto hash = SHA256::hex(data);
+      std::string shard = hash.substr(0, 2);
+      std::string object = shard + "/" + hash + "." + factory->extension();
+
+      if(std::string shardPath = objectStoreFilePath + "/" + shard; !tp_utils::exists(shardPath))
+        tp_utils::mkdir(shardPath, TPCreateFullPath::Yes);
+
+      if(!writeObject(objectStoreFilePath + "/" + object, data))
+      {
+        error = "Failed to write object for member: " + name.toString();
+        return;
+      }
+
+      j["hash"] = hash;
+      j["object"] = objectStoreIndexPath + "/" + object;
+    }
+
+    newMembers.push_back(name);
+    membersIndex.push_back(j);
   }
 
   //-- Add in existing members ---------------------------------------------------------------------
@@ -522,17 +1215,170 @@ void CollectionFactory::saveToPath(std::string& error,
 #endif
 }
 
+//##################################################################################################
+void CollectionFactory::setExecutor(const std::shared_ptr<AbstractExecutor>& executor)
+{
+  //Release the old executor without the lock held, its destructor may wait for running tasks.
+  std::shared_ptr<AbstractExecutor> previous = executor;
+  {
+    std::lock_guard<std::mutex> lock(d->asyncMutex);
+    std::swap(previous, d->executor);
+  }
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractExecutor> CollectionFactory::executor() const
+{
+  std::lock_guard<std::mutex> lock(d->asyncMutex);
+  return d->executor;
+}
+
+//##################################################################################################
+void CollectionFactory::setMaxInFlight(size_t maxInFlight)
+{
+  std::vector<std::function<void()>> ready;
+  std::shared_ptr<AbstractExecutor> e;
+  {
+    std::lock_guard<std::mutex> lock(d->asyncMutex);
+    d->maxInFlight = maxInFlight;
+    d->takeReady(ready, e);
+  }
+
+  d->start(e, ready);
+}
+
+//##################################################################################################
+size_t CollectionFactory::maxInFlight() const
+{
+  std::lock_guard<std::mutex> lock(d->asyncMutex);
+  return d->maxInFlight;
+}
+
+//##################################################################################################
+std::future<AsyncLoadResult> CollectionFactory::loadFromPathAsync(const std::string& path,
+                                                                  const std::vector<std::string>& subset,
+                                                                  const CancellationToken& cancellationToken) const
+{
+  std::future<AsyncLoadResult> future;
+  loadFromPathAsync(path, promiseCallback(future), subset, cancellationToken);
+  return future;
+}
+
+//##################################################################################################
+void CollectionFactory::loadFromPathAsync(const std::string& path,
+                                          const std::function<void(AsyncLoadResult&&)>& callback,
+                                          const std::vector<std::string>& subset,
+                                          const CancellationToken& cancellationToken) const
+{
+  d->submit([=]
+  {
+    AsyncLoadResult result;
+    runAsync(result, cancellationToken, [&]
+    {
+      result.collection = std::make_shared<Collection>();
+      loadFromPath(result.error, path, *result.collection, subset);
+    });
+    callback(std::move(result));
+  });
+}
+
+//##################################################################################################
+std::future<AsyncLoadResult> CollectionFactory::loadFromDataAsync(std::string data,
+                                                                  const std::vector<std::string>& subset,
+                                                                  const CancellationToken& cancellationToken) const
+{
+  std::future<AsyncLoadResult> future;
+  loadFromDataAsync(std::move(data), promiseCallback(future), subset, cancellationToken);
+  return future;
+}
+
+//##################################################################################################
+void CollectionFactory::loadFromDataAsync(std::string data,
+                                          const std::function<void(AsyncLoadResult&&)>& callback,
+                                          const std::vector<std::string>& subset,
+                                          const CancellationToken& cancellationToken) const
+{
+  d->submit([=, data=std::move(data)]
+  {
+    AsyncLoadResult result;
+    runAsync(result, cancellationToken, [&]
+    {
+      result.collection = std::make_shared<Collection>();
+      loadFromData(result.error, data, *result.collection, subset);
+    });
+    callback(std::move(result));
+  });
+}
+
+//##################################################################################################
+std::future<AsyncSaveDataResult> CollectionFactory::saveToDataAsync(const std::shared_ptr<const Collection>& collection,
+                                                                    const CancellationToken& cancellationToken) const
+{
+  std::future<AsyncSaveDataResult> future;
+  saveToDataAsync(collection, promiseCallback(future), cancellationToken);
+  return future;
+}
+
+//##################################################################################################
+void CollectionFactory::saveToDataAsync(const std::shared_ptr<const Collection>& collection,
+                                        const std::function<void(AsyncSaveDataResult&&)>& callback,
+                                        const CancellationToken& cancellationToken) const
+{
+  d->submit([=]
+  {
+    AsyncSaveDataResult result;
+    runAsync(result, cancellationToken, [&]
+    {
+      saveToData(result.error, *collection, result.data);
+    });
+    callback(std::move(result));
+  });
+}
+
+//##################################################################################################
+std::future<AsyncResult> CollectionFactory::saveToPathAsync(const std::shared_ptr<const Collection>& collection,
+                                                            const std::string& path,
+                                                            bool append,
+                                                            const CancellationToken& cancellationToken) const
+{
+  std::future<AsyncResult> future;
+  saveToPathAsync(collection, path, promiseCallback(future), append, cancellationToken);
+  return future;
+}
+
+//##################################################################################################
+void CollectionFactory::saveToPathAsync(const std::shared_ptr<const Collection>& collection,
+                                        const std::string& path,
+                                        const std::function<void(AsyncResult&&)>& callback,
+                                        bool append,
+                                        const CancellationToken& cancellationToken) const
+{
+  d->submit([=]
+  {
+    AsyncResult result;
+    runAsync(result, cancellationToken, [&]
+    {
+      saveToPath(result.error, *collection, path, append);
+    });
+    callback(std::move(result));
+  });
+}
+
 //##################################################################################################
 std::shared_ptr<AbstractMember> CollectionFactory::clone(std::string& error, const AbstractMember& member) const
 {
-  auto factory = memberFactory(member.type());
+  auto factory = memberFactory(member);
   if(!factory)
   {
     error = "Failed to find factory for member type: " + member.type().toString();
     return nullptr;
   }
 
-  return factory->clone(error, member);
+  TP_DATA_TRACE_MEMBER_SCOPE(trace, "clone member", member.name(), member.type());
+  CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Clone);
+  auto newMember = factory->clone(error, member);
+  scope.stop(1, 0, !newMember);
+  return newMember;
 }
 
 //##################################################################################################
@@ -541,16 +1387,383 @@ void CollectionFactory::serializeMember(std::string& error,
                                         std::string& data,
                                         std::string& extension) const
 {
-  auto factory = memberFactory(member.type());
+  auto factory = memberFactory(member);
   if(!factory)
   {
     error = "Failed to find factory for member type: " + member.type().toString();
     return;
   }
 
+  TP_DATA_TRACE_MEMBER_SCOPE(trace, "save member", member.name(), member.type());
+  CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Save);
   factory->save(error, member, data);
+  scope.stop(1, data.size(), !error.empty());
+  TP_DATA_TRACE_BYTES(trace, data.size());
   extension = factory->extension();
 }
 
+//##################################################################################################
+uint64_t CollectionFactory::memberHash(std::string& error, const AbstractMember& member) const
+{
+  auto factory = memberFactory(member);
+  if(!factory)
+  {
+    error = "Failed to find factory for member type: " + member.type().toString();
+    return 0;
+  }
+
+  //Reuse the buffer for small members but don't keep a large member allocated on every thread.
+  constexpr size_t maxRetainedBytes = 1024*1024;
+  thread_local std::string data;
+  data.clear();
+  {
+    TP_DATA_TRACE_MEMBER_SCOPE(trace, "hash member", member.name(), member.type());
+    factory->saveAppend(error, member, data);
+    TP_DATA_TRACE_BYTES(trace, data.size());
+  }
+
+  uint64_t hash=0;
+  if(!error.empty())
+    error += "Failed to serialize name:" + member.name().toString() + " type:" + member.type().toString();
+  else
+    hash = std::max(hash64(data), uint64_t(1)); //0 is reserved for errors.
+
+  if(data.capacity() > maxRetainedBytes)
+    std::string().swap(data);
+
+  return hash;
+}
+
+//##################################################################################################
+void CollectionFactory::diff(std::string& error, const Collection& a, const Collection& b, CollectionDiff& output) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "diff");
+  output = CollectionDiff();
+
+  std::unordered_map<tp_utils::StringID, const AbstractMember*> membersA;
+  membersA.reserve(a.members().size());
+  for(const auto& member : a.members())
+    membersA.emplace(member->name(), member.get());
+
+  std::unordered_map<tp_utils::StringID, const AbstractMember*> membersB;
+  membersB.reserve(b.members().size());
+  for(const auto& member : b.members())
+  {
+    membersB.emplace(member->name(), member.get());
+
+    auto i = membersA.find(member->name());
+    if(i == membersA.end())
+    {
+      output.added.push_back(member->name());
+      continue;
+    }
+
+    const AbstractMember* memberA = i->second;
+    if(memberA->type() != member->type())
+    {
+      output.changed.push_back(member->name());
+      continue;
+    }
+
+    auto hashA = memberHash(error, *memberA);
+    auto hashB = memberHash(error, *member);
+    if(!error.empty())
+      return;
+
+    if(hashA != hashB)
+      output.changed.push_back(member->name());
+  }
+
+  for(const auto& member : a.members())
+    if(membersB.find(member->name()) == membersB.end())
+      output.removed.push_back(member->name());
+}
+
+//##################################################################################################
+void CollectionFactory::savePatch(std::string& error, const Collection& a, const Collection& b, std::string& patch) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "savePatch");
+  patch.clear();
+
+  //Members smaller than this are always sent in full.
+  constexpr size_t minDeltaSize = 4096;
+
+  CollectionDiff changes;
+  diff(error, a, b, changes);
+  if(!error.empty())
+    return;
+
+  std::unordered_set<tp_utils::StringID> changed(changes.changed.begin(), changes.changed.end());
+
+  std::unordered_map<tp_utils::StringID, const AbstractMember*> membersA;
+  membersA.reserve(a.members().size());
+  for(const auto& member : a.members())
+    membersA.emplace(member->name(), member.get());
+
+  addPart(patch, "patch", "1");
+  addPart(patch, "name", b.name());
+  addPart(patch, "timestamp", std::to_string(b.timestampMS()));
+
+  for(const auto& name : changes.removed)
+    addPart(patch, "remove", name.toString());
+
+  std::string baseData;
+  std::string targetData;
+  std::string delta;
+  for(const auto& member : b.members())
+  {
+    const AbstractMember* memberA{nullptr};
+    if(auto i=membersA.find(member->name()); i!=membersA.end())
+      memberA = i->second;
+
+    bool isChanged = !memberA || changed.find(member->name()) != changed.end();
+    if(!isChanged && memberA->timestampMS() == member->timestampMS())
+      continue;
+
+    auto factory = memberFactory(*member);
+    if(!factory)
+    {
+      error = "Failed to find factory for member type: " + member->type().toString();
+      return;
+    }
+
+    size_t memberStart = patch.size();
+    addPart(patch, "member", member->name().toString());
+    addPart(patch, "type", member->type().keyString());
+    addPart(patch, "timestamp", std::to_string(member->timestampMS()));
+
+    //Only the timestamp has changed.
+    if(!isChanged)
+      continue;
+
+    targetData.clear();
+    factory->saveAppend(error, *member, targetData);
+
+    //Try a delta against the old version of the member.
+    bool sent=false;
+    if(error.empty() && memberA && memberA->type() == member->type() && targetData.size()>=minDeltaSize)
+    {
+      baseData.clear();
+      factory->saveAppend(error, *memberA, baseData);
+
+      delta.clear();
+      if(error.empty())
+        makeBinaryDelta(baseData, targetData, delta);
+
+      if(error.empty() && delta.size() < (targetData.size()/4)*3)
+      {
+        addPart(patch, "base", std::to_string(hash64(baseData)));
+        size_t lengthOffset = beginPart(patch, "delta");
+        patch.append(delta);
+        sent = endPart(error, patch, lengthOffset);
+      }
+    }
+
+    if(!sent && error.empty())
+    {
+      size_t lengthOffset = beginPart(patch, "data");
+      patch.append(targetData);
+      endPart(error, patch, lengthOffset);
+    }
+
+    if(!error.empty())
+    {
+      patch.resize(memberStart);
+      error += "Failed to serialize name:" + member->name().toString() + " type:" + member->type().toString();
+      return;
+    }
+  }
+}
+
+//##################################################################################################
+void CollectionFactory::applyPatch(std::string& error, const std::string& patch, Collection& collection) const
+{
+  TP_DATA_TRACE_SCOPE(trace, "applyPatch");
+  TP_DATA_TRACE_BYTES(trace, patch.size());
+
+  //Changes are staged and only applied to the collection once the whole patch has been decoded.
+  std::string name = collection.name();
+  int64_t timestampMS = collection.timestampMS();
+  std::vector<tp_utils::StringID> removed;
+  std::vector<std::shared_ptr<AbstractMember>> replaced;
+  std::vector<std::pair<std::shared_ptr<AbstractMember>, int64_t>> touched;
+
+  struct Entry
+  {
+    std::string name;
+    std::string type;
+    int64_t timestampMS{0};
+    std::string_view data;
+    std::string_view delta;
+    uint64_t baseHash{0};
+    bool hasData{false};
+    bool hasDelta{false};
+  };
+  Entry entry;
+
+  std::string baseData;
+  std::string targetData;
+  auto flushEntry = [&]()
+  {
+    if(entry.name.empty())
+      return true;
+
+    Entry current = std::move(entry);
+    entry = Entry();
+    tp_utils::StringID memberName(current.name);
+    const auto& existing = collection.member(memberName);
+
+    if(!current.hasData && !current.hasDelta)
+    {
+      if(!existing)
+      {
+        error = "Patch changes the timestamp of a missing member: " + current.name;
+        return false;
+      }
+      touched.emplace_back(existing, current.timestampMS);
+      return true;
+    }
+
+    auto factory = memberFactoryByName(current.type);
+    if(!factory)
+    {
+      error = "Failed to find member factory for: " + current.type;
+      return false;
+    }
+
+    std::string_view memberData = current.data;
+    if(current.hasDelta)
+    {
+      if(!existing || existing->type().keyString() != current.type)
+      {
+        error = "Patch has a delta for a missing member: " + current.name;
+        return false;
+      }
+
+      baseData.clear();
+      factory->saveAppend(error, *existing, baseData);
+      if(!error.empty())
+        return false;
+
+      if(hash64(baseData) != current.baseHash)
+      {
+        error = "Patch does not match the current version of member: " + current.name;
+        return false;
+      }
+
+      targetData.clear();
+      if(!applyBinaryDelta(error, baseData, current.delta, targetData))
+        return false;
+
+      memberData = targetData;
+    }
+
+    CountedScope scope(d->counters, factory->typeIndex(), CountedOperation::Load);
+    auto member = factory->loadView(error, memberData);
+    scope.stop(1, memberData.size(), !member || !error.empty());
+    if(!member || !error.empty())
+    {
+      error = "Failed to load a member, name: " + current.name + " type: " + current.type;
+      return false;
+    }
+
+    member->setName(memberName);
+    member->setTimestampMS(current.timestampMS);
+    member->setTypeIndex(factory->typeIndex());
+    replaced.push_back(std::move(member));
+    return true;
+  };
+
+  auto toInt64 = [](std::string_view value)
+  {
+    int64_t result{0};
+    std::from_chars(value.data(), value.data()+value.size(), result);
+    return result;
+  };
+
+  bool isPatch=false;
+  size_t startFrom = 0;
+  std::string key;
+  size_t partOffset=0;
+  size_t partLen=0;
+  while(parsePart(error, patch.data(), patch.size(), startFrom, key, partOffset, partLen))
+  {
+    std::string_view partData(patch.data()+partOffset, partLen);
+
+    if(key == "patch")
+      isPatch = (partData == "1");
+
+    else if(!isPatch)
+      break;
+
+    else if(key == "member" || key == "remove")
+    {
+      if(!flushEntry())
+        return;
+
+      if(key == "remove")
+        removed.emplace_back(std::string(partData));
+      else
+        entry.name = partData;
+    }
+
+    else if(key == "type")
+      entry.type = partData;
+
+    else if(key == "timestamp")
+    {
+      if(!entry.name.empty())
+        entry.timestampMS = toInt64(partData);
+      else
+        timestampMS = toInt64(partData);
+    }
+
+    else if(key == "name")
+      name = partData;
+
+    else if(key == "data")
+    {
+      entry.data = partData;
+      entry.hasData = true;
+    }
+
+    else if(key == "delta")
+    {
+      entry.delta = partData;
+      entry.hasDelta = true;
+    }
+
+    else if(key == "base")
+    {
+      uint64_t hash{0};
+      std::from_chars(partData.data(), partData.data()+partData.size(), hash);
+      entry.baseHash = hash;
+    }
+  }
+
+  if(!error.empty())
+    return;
+
+  if(!isPatch)
+  {
+    error = "Data is not a supported patch.";
+    return;
+  }
+
+  if(!flushEntry())
+    return;
+
+  for(const auto& memberName : removed)
+    collection.removeMember(memberName);
+
+  for(const auto& member : replaced)
+    collection.replaceMember(member);
+
+  for(const auto& [member, memberTimestampMS] : touched)
+    member->setTimestampMS(memberTimestampMS);
+
+  collection.setName(name);
+  collection.setTimestampMS(timestampMS);
 }
 
+}
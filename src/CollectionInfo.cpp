@@ -0,0 +1,38 @@
+#include "tp_data/CollectionInfo.h"
+
+namespace tp_data
+{
+
+//##################################################################################################
+nlohmann::json MemberInfo::toJSON() const
+{
+  nlohmann::json j;
+  j["name"]         = name;
+  j["type"]         = type;
+  j["timestamp"]    = timestampMS;
+  j["encoded_size"] = encodedSize;
+  return j;
+}
+
+//##################################################################################################
+size_t CollectionInfo::encodedSize() const
+{
+  size_t size=0;
+  for(const auto& member : members)
+    size += member.encodedSize;
+  return size;
+}
+
+//##################################################################################################
+nlohmann::json CollectionInfo::toJSON() const
+{
+  nlohmann::json j;
+  j["name"]      = name;
+  j["timestamp"] = timestampMS;
+  j["members"]   = nlohmann::json::array();
+  for(const auto& member : members)
+    j["members"].push_back(member.toJSON());
+  return j;
+}
+
+}
@@ -0,0 +1,246 @@
+#include "tp_data/ContentHash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tp_data
+{
+
+namespace
+{
+//##################################################################################################
+constexpr uint32_t k[64] =
+{
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+//##################################################################################################
+inline uint32_t rotr(uint32_t x, uint32_t n)
+{
+  return (x >> n) | (x << (32-n));
+}
+
+//##################################################################################################
+constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t prime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ULL;
+
+//##################################################################################################
+inline uint64_t rotl64(uint64_t x, uint32_t n)
+{
+  return (x << n) | (x >> (64-n));
+}
+
+//##################################################################################################
+inline uint64_t read64(const char* p)
+{
+  uint64_t value;
+  std::memcpy(&value, p, 8);
+  return value;
+}
+
+//##################################################################################################
+inline uint32_t read32(const char* p)
+{
+  uint32_t value;
+  std::memcpy(&value, p, 4);
+  return value;
+}
+
+//##################################################################################################
+inline uint64_t round64(uint64_t acc, uint64_t input)
+{
+  acc += input * prime64_2;
+  acc = rotl64(acc, 31);
+  return acc * prime64_1;
+}
+
+//##################################################################################################
+inline uint64_t mergeRound64(uint64_t acc, uint64_t value)
+{
+  acc ^= round64(0, value);
+  return acc * prime64_1 + prime64_4;
+}
+}
+
+//##################################################################################################
+uint64_t hash64(std::string_view data, uint64_t seed)
+{
+  const char* p = data.data();
+  const char* end = p + data.size();
+  uint64_t h;
+
+  if(data.size()>=32)
+  {
+    uint64_t v1 = seed + prime64_1 + prime64_2;
+    uint64_t v2 = seed + prime64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - prime64_1;
+
+    for(const char* limit = end-32; p<=limit; p+=32)
+    {
+      v1 = round64(v1, read64(p));
+      v2 = round64(v2, read64(p+8));
+      v3 = round64(v3, read64(p+16));
+      v4 = round64(v4, read64(p+24));
+    }
+
+    h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h = mergeRound64(h, v1);
+    h = mergeRound64(h, v2);
+    h = mergeRound64(h, v3);
+    h = mergeRound64(h, v4);
+  }
+  else
+    h = seed + prime64_5;
+
+  h += uint64_t(data.size());
+
+  for(; p+8<=end; p+=8)
+  {
+    h ^= round64(0, read64(p));
+    h = rotl64(h, 27) * prime64_1 + prime64_4;
+  }
+
+  if(p+4<=end)
+  {
+    h ^= uint64_t(read32(p)) * prime64_1;
+    h = rotl64(h, 23) * prime64_2 + prime64_3;
+    p += 4;
+  }
+
+  for(; p<end; p++)
+  {
+    h ^= uint64_t(uint8_t(*p)) * prime64_5;
+    h = rotl64(h, 11) * prime64_1;
+  }
+
+  h ^= h >> 33;
+  h *= prime64_2;
+  h ^= h >> 29;
+  h *= prime64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+//##################################################################################################
+SHA256::SHA256():
+  m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}
+{
+
+}
+
+//##################################################################################################
+void SHA256::add(std::string_view data)
+{
+  auto input = reinterpret_cast<const uint8_t*>(data.data());
+  size_t size = data.size();
+  m_length += size;
+
+  if(m_bufferSize>0)
+  {
+    size_t n = std::min(size, 64-m_bufferSize);
+    std::memcpy(m_buffer.data()+m_bufferSize, input, n);
+    m_bufferSize += n;
+    input += n;
+    size -= n;
+
+    if(m_bufferSize<64)
+      return;
+
+    processBlock(m_buffer.data());
+    m_bufferSize = 0;
+  }
+
+  for(; size>=64; input+=64, size-=64)
+    processBlock(input);
+
+  std::memcpy(m_buffer.data(), input, size);
+  m_bufferSize = size;
+}
+
+//##################################################################################################
+std::array<uint8_t, 32> SHA256::finish()
+{
+  uint64_t bitLength = m_length*8;
+
+  uint8_t padding[72] = {0x80};
+  size_t padLength = (m_bufferSize<56)?(56-m_bufferSize):(120-m_bufferSize);
+  for(size_t i=0; i<8; i++)
+    padding[padLength+i] = uint8_t(bitLength >> (56-8*i));
+  add(std::string_view(reinterpret_cast<const char*>(padding), padLength+8));
+
+  std::array<uint8_t, 32> digest;
+  for(size_t i=0; i<8; i++)
+    for(size_t b=0; b<4; b++)
+      digest[i*4+b] = uint8_t(m_state[i] >> (24-8*b));
+  return digest;
+}
+
+//##################################################################################################
+std::string SHA256::finishHex()
+{
+  static const char* digits = "0123456789abcdef";
+  std::string result;
+  result.reserve(64);
+  for(auto byte : finish())
+  {
+    result.push_back(digits[byte>>4]);
+    result.push_back(digits[byte&15]);
+  }
+  return result;
+}
+
+//##################################################################################################
+std::string SHA256::hex(std::string_view data)
+{
+  SHA256 sha;
+  sha.add(data);
+  return sha.finishHex();
+}
+
+//##################################################################################################
+void SHA256::processBlock(const uint8_t* block)
+{
+  uint32_t w[64];
+  for(size_t i=0; i<16; i++)
+    w[i] = (uint32_t(block[i*4])<<24) | (uint32_t(block[i*4+1])<<16) | (uint32_t(block[i*4+2])<<8) | uint32_t(block[i*4+3]);
+
+  for(size_t i=16; i<64; i++)
+  {
+    uint32_t s0 = rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+    uint32_t s1 = rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+    w[i] = w[i-16] + s0 + w[i-7] + s1;
+  }
+
+  uint32_t a=m_state[0], b=m_state[1], c=m_state[2], d=m_state[3];
+  uint32_t e=m_state[4], f=m_state[5], g=m_state[6], h=m_state[7];
+
+  for(size_t i=0; i<64; i++)
+  {
+    uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+    uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  m_state[0]+=a; m_state[1]+=b; m_state[2]+=c; m_state[3]+=d;
+  m_state[4]+=e; m_state[5]+=f; m_state[6]+=g; m_state[7]+=h;
+}
+
+}
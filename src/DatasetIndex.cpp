@@ -0,0 +1,817 @@
+#include "tp_data/DatasetIndex.h"
+#include "tp_data/Collection.h"
+#include "tp_data/CollectionFactory.h"
+#include "tp_data/LoadFilter.h"
+#include "tp_data/members/NumberMember.h"
+#include "tp_data/members/StringIDMember.h"
+#include "tp_data/members/StringMember.h"
+
+#include "tp_utils/FileUtils.h"
+#include "tp_utils/JSONUtils.h"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace tp_data
+{
+
+namespace
+{
+//##################################################################################################
+struct Value
+{
+  bool isText{false};
+  std::string text;
+  DatasetNumber number{0.0};
+};
+
+//##################################################################################################
+//! The indexed values of one collection, by member name.
+struct Entry
+{
+  std::string key;
+  std::vector<std::pair<std::string, Value>> values;
+};
+
+//##################################################################################################
+struct MemberIndex
+{
+  std::unordered_map<std::string, std::set<size_t>> text;
+  std::multimap<DatasetNumber, size_t> numbers;
+};
+
+//##################################################################################################
+template<typename M>
+bool numberValue(const AbstractMember& member, Value& value)
+{
+  if(member.type() != M::memberType())
+    return false;
+
+  value.number = static_cast<const M&>(member).data;
+  return true;
+}
+
+//##################################################################################################
+//! Compare an integer with a double exactly, returns <0, 0, or >0.
+template<typename I>
+int compareIntegerDouble(I i, double d)
+{
+  //The range of I as doubles, [lower, upper).
+  const double upper = std::ldexp(1.0, std::numeric_limits<I>::digits);
+  const double lower = std::numeric_limits<I>::is_signed?-upper:0.0;
+  if(d>=upper)
+    return -1;
+  if(d<lower)
+    return 1;
+
+  I t = I(d);
+  if(i!=t)
+    return (i<t)?-1:1;
+
+  double fraction = d - double(t);
+  return (fraction>0.0)?-1:((fraction<0.0)?1:0);
+}
+
+//##################################################################################################
+int compareNumbers(const DatasetNumber& a, const DatasetNumber& b)
+{
+  using Kind = DatasetNumber::Kind;
+
+  auto compare = [](auto x, auto y)
+  {
+    return (x<y)?-1:((y<x)?1:0);
+  };
+
+  switch(a.kind)
+  {
+  case Kind::Int64:
+    switch(b.kind)
+    {
+    case Kind::Int64:  return compare(a.int64, b.int64);
+    case Kind::UInt64: return (a.int64<0)?-1:compare(uint64_t(a.int64), b.uint64);
+    case Kind::Double: return compareIntegerDouble(a.int64, b.real);
+    }
+    break;
+
+  case Kind::UInt64:
+    switch(b.kind)
+    {
+    case Kind::Int64:  return (b.int64<0)?1:compare(a.uint64, uint64_t(b.int64));
+    case Kind::UInt64: return compare(a.uint64, b.uint64);
+    case Kind::Double: return compareIntegerDouble(a.uint64, b.real);
+    }
+    break;
+
+  case Kind::Double:
+    switch(b.kind)
+    {
+    case Kind::Int64:  return -compareIntegerDouble(b.int64, a.real);
+    case Kind::UInt64: return -compareIntegerDouble(b.uint64, a.real);
+    case Kind::Double: return compare(a.real, b.real);
+    }
+    break;
+  }
+
+  return 0;
+}
+
+//##################################################################################################
+//! Get the indexable value of a member, returns false for types that are not indexed.
+bool memberValue(const AbstractMember& member, Value& value)
+{
+  if(member.type() == stringSID())
+  {
+    value.isText = true;
+    value.text = static_cast<const StringMember&>(member).data;
+    return true;
+  }
+
+  if(member.type() == stringIDSID())
+  {
+    value.isText = true;
+    value.text = static_cast<const StringIDMember&>(member).data.toString();
+    return true;
+  }
+
+  return numberValue<IntMember>(member, value) ||
+      numberValue<SizeTMember>(member, value) ||
+      numberValue<FloatMember>(member, value) ||
+      numberValue<DoubleMember>(member, value) ||
+      numberValue<Int64Member>(member, value) ||
+      numberValue<UInt64Member>(member, value);
+}
+
+//##################################################################################################
+//! Get the value of a member if it can be indexed, NaN is rejected as it can't be ordered.
+bool indexableValue(const AbstractMember& member, Value& value)
+{
+  return memberValue(member, value) && (value.isText || !value.number.isNaN());
+}
+
+//##################################################################################################
+//! True if no number can match the condition, begin would then be after end in the index.
+bool isEmptyRange(const DatasetQuery::Condition& condition)
+{
+  if(condition.min.isNaN() || condition.max.isNaN() || condition.max<condition.min)
+    return true;
+
+  //min==max only matches if both ends are inclusive.
+  if(!(condition.min<condition.max))
+    return !condition.minInclusive || !condition.maxInclusive;
+
+  return false;
+}
+
+//##################################################################################################
+nlohmann::json valuesToJSON(const std::vector<std::pair<std::string, Value>>& values)
+{
+  nlohmann::json j = nlohmann::json::object();
+  for(const auto& i : values)
+  {
+    if(i.second.isText)
+      j[i.first] = i.second.text;
+    else
+    {
+      const auto& number = i.second.number;
+      switch(number.kind)
+      {
+      case DatasetNumber::Kind::Int64:  j[i.first] = number.int64;  break;
+      case DatasetNumber::Kind::UInt64: j[i.first] = number.uint64; break;
+      case DatasetNumber::Kind::Double: j[i.first] = number.real;   break;
+      }
+    }
+  }
+  return j;
+}
+
+//##################################################################################################
+std::vector<std::pair<std::string, Value>> valuesFromJSON(const nlohmann::json& j)
+{
+  std::vector<std::pair<std::string, Value>> values;
+  const auto jj=j.find("values");
+  if(jj==j.end() || !jj->is_object())
+    return values;
+
+  for(auto i=jj->begin(); i!=jj->end(); ++i)
+  {
+    Value value;
+    if(i.value().is_string())
+    {
+      value.isText = true;
+      value.text = i.value().get<std::string>();
+    }
+    else if(i.value().is_number_unsigned())
+      value.number = i.value().get<uint64_t>();
+    else if(i.value().is_number_integer())
+      value.number = i.value().get<int64_t>();
+    else if(i.value().is_number_float() && !std::isnan(i.value().get<double>()))
+      value.number = i.value().get<double>();
+    else
+      continue;
+
+    values.emplace_back(i.key(), std::move(value));
+  }
+  return values;
+}
+}
+
+//##################################################################################################
+bool DatasetNumber::isNaN() const
+{
+  return kind==Kind::Double && std::isnan(real);
+}
+
+//##################################################################################################
+bool DatasetNumber::operator<(const DatasetNumber& other) const
+{
+  return compareNumbers(*this, other)<0;
+}
+
+//##################################################################################################
+DatasetQuery& DatasetQuery::equals(const tp_utils::StringID& name, const std::string& value)
+{
+  auto& condition = m_conditions.emplace_back();
+  condition.name = name;
+  condition.isText = true;
+  condition.text = value;
+  return *this;
+}
+
+//##################################################################################################
+DatasetQuery& DatasetQuery::equals(const tp_utils::StringID& name, const DatasetNumber& value)
+{
+  return between(name, value, value);
+}
+
+//##################################################################################################
+DatasetQuery& DatasetQuery::greaterThan(const tp_utils::StringID& name, const DatasetNumber& value)
+{
+  auto& condition = m_conditions.emplace_back();
+  condition.name = name;
+  condition.min = value;
+  condition.minInclusive = false;
+  return *this;
+}
+
+//##################################################################################################
+DatasetQuery& DatasetQuery::lessThan(const tp_utils::StringID& name, const DatasetNumber& value)
+{
+  auto& condition = m_conditions.emplace_back();
+  condition.name = name;
+  condition.max = value;
+  condition.maxInclusive = false;
+  return *this;
+}
+
+//##################################################################################################
+DatasetQuery& DatasetQuery::between(const tp_utils::StringID& name, const DatasetNumber& min, const DatasetNumber& max)
+{
+  auto& condition = m_conditions.emplace_back();
+  condition.name = name;
+  condition.min = min;
+  condition.max = max;
+  return *this;
+}
+
+//##################################################################################################
+const std::vector<DatasetQuery::Condition>& DatasetQuery::conditions() const
+{
+  return m_conditions;
+}
+
+//##################################################################################################
+struct DatasetIndex::Private
+{
+  const CollectionFactory* collectionFactory;
+
+  mutable std::mutex mutex;
+
+  std::vector<tp_utils::StringID> indexedMembers;
+
+  std::string indexPath;
+  std::ofstream journal;
+
+  //Entries are addressed by slot, removed slots are reused.
+  std::vector<Entry> entries;
+  std::vector<size_t> freeSlots;
+  std::unordered_map<std::string, size_t> slots;
+  std::unordered_map<std::string, MemberIndex> members;
+
+  //################################################################################################
+  Private(const CollectionFactory* collectionFactory_):
+    collectionFactory(collectionFactory_)
+  {
+
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  bool isIndexed(const std::string& name) const
+  {
+    for(const auto& indexedMember : indexedMembers)
+      if(indexedMember.toString() == name)
+        return true;
+    return false;
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  void addIndexedMember(const std::string& name)
+  {
+    if(!isIndexed(name))
+      indexedMembers.emplace_back(name);
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  void removeEntry(const std::string& key)
+  {
+    auto s = slots.find(key);
+    if(s == slots.end())
+      return;
+
+    size_t slot = s->second;
+    auto& entry = entries.at(slot);
+    for(const auto& i : entry.values)
+    {
+      auto& memberIndex = members[i.first];
+      if(i.second.isText)
+      {
+        auto t = memberIndex.text.find(i.second.text);
+        if(t != memberIndex.text.end())
+        {
+          t->second.erase(slot);
+          if(t->second.empty())
+            memberIndex.text.erase(t);
+        }
+      }
+      else
+      {
+        auto range = memberIndex.numbers.equal_range(i.second.number);
+        for(auto n=range.first; n!=range.second; ++n)
+        {
+          if(n->second == slot)
+          {
+            memberIndex.numbers.erase(n);
+            break;
+          }
+        }
+      }
+    }
+
+    entry = Entry();
+    freeSlots.push_back(slot);
+    slots.erase(s);
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  void setEntry(const std::string& key, std::vector<std::pair<std::string, Value>>&& values)
+  {
+    removeEntry(key);
+
+    size_t slot;
+    if(!freeSlots.empty())
+    {
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+    }
+    else
+    {
+      slot = entries.size();
+      entries.emplace_back();
+    }
+
+    for(const auto& i : values)
+    {
+      auto& memberIndex = members[i.first];
+      if(i.second.isText)
+        memberIndex.text[i.second.text].insert(slot);
+      else
+        memberIndex.numbers.emplace(i.second.number, slot);
+    }
+
+    auto& entry = entries.at(slot);
+    entry.key = key;
+    entry.values = std::move(values);
+    slots[key] = slot;
+  }
+
+  //################################################################################################
+  // Call with the mutex locked.
+  bool appendJournal(std::string& error, const nlohmann::json& j)
+  {
+    if(indexPath.empty())
+      return true;
+
+    journal << j.dump() << '\n';
+    journal.flush();
+    if(!journal)
+    {
+      error = "Failed to write dataset index journal: " + indexPath + ".journal";
+      return false;
+    }
+
+    return true;
+  }
+
+  //################################################################################################
+  //! Rewrite the index file and empty the journal.
+  // Call with the mutex locked.
+  bool compact(std::string& error)
+  {
+    if(indexPath.empty())
+    {
+      error = "Dataset index has not been opened.";
+      return false;
+    }
+
+    nlohmann::json j;
+    j["members"] = nlohmann::json::array();
+    for(const auto& name : indexedMembers)
+      j["members"].push_back(name.toString());
+
+    j["collections"] = nlohmann::json::array();
+    for(const auto& s : slots)
+    {
+      const auto& entry = entries.at(s.second);
+      nlohmann::json jj;
+      jj["key"] = entry.key;
+      jj["values"] = valuesToJSON(entry.values);
+      j["collections"].push_back(jj);
+    }
+
+    //Write to a temporary file and rename it so a reader never sees a partial index.
+    std::string tmpPath = indexPath + ".tmp";
+    if(!tp_utils::writeBinaryFile(tmpPath, j.dump()) || std::rename(tmpPath.c_str(), indexPath.c_str())!=0)
+    {
+      std::remove(tmpPath.c_str());
+      error = "Failed to write dataset index: " + indexPath;
+      return false;
+    }
+
+    std::string journalPath = indexPath + ".journal";
+    journal.close();
+    journal.open(journalPath, std::ios::binary | std::ios::trunc);
+    if(!journal)
+    {
+      error = "Failed to open dataset index journal: " + journalPath;
+      return false;
+    }
+
+    return true;
+  }
+
+  //################################################################################################
+  //! Apply a journal record, returns false if the record is not valid.
+  // Call with the mutex locked.
+  bool applyRecord(const nlohmann::json& j)
+  {
+    if(!j.is_object())
+      return false;
+
+    std::string op = TPJSONString(j, "op");
+    if(op == "member")
+      addIndexedMember(TPJSONString(j, "name"));
+    else if(op == "update")
+      setEntry(TPJSONString(j, "key"), valuesFromJSON(j));
+    else if(op == "remove")
+      removeEntry(TPJSONString(j, "key"));
+    else
+      return false;
+
+    return true;
+  }
+
+  //################################################################################################
+  bool update(std::string& error, const std::string& key, const Collection& collection)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<std::pair<std::string, Value>> values;
+    for(const auto& name : indexedMembers)
+    {
+      const auto& member = collection.member(name);
+      Value value;
+      if(member && indexableValue(*member, value))
+        values.emplace_back(name.toString(), std::move(value));
+    }
+
+    nlohmann::json j;
+    j["op"] = "update";
+    j["key"] = key;
+    j["values"] = valuesToJSON(values);
+
+    setEntry(key, std::move(values));
+    return appendJournal(error, j);
+  }
+
+  //################################################################################################
+  LoadFilter filter() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    LoadFilter filter;
+    for(const auto& name : indexedMembers)
+      filter.addName(name.toString());
+    return filter;
+  }
+};
+
+//##################################################################################################
+DatasetIndex::DatasetIndex(const CollectionFactory* collectionFactory):
+  d(new Private(collectionFactory))
+{
+
+}
+
+//##################################################################################################
+DatasetIndex::~DatasetIndex()
+{
+  delete d;
+}
+
+//##################################################################################################
+bool DatasetIndex::addIndexedMember(std::string& error, const tp_utils::StringID& name)
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  if(d->isIndexed(name.toString()))
+    return true;
+
+  nlohmann::json j;
+  j["op"] = "member";
+  j["name"] = name.toString();
+
+  //Only index the member if it will still be indexed when the index is opened again.
+  if(!d->appendJournal(error, j))
+    return false;
+
+  d->indexedMembers.push_back(name);
+  return true;
+}
+
+//##################################################################################################
+const std::vector<tp_utils::StringID>& DatasetIndex::indexedMembers() const
+{
+  return d->indexedMembers;
+}
+
+//##################################################################################################
+bool DatasetIndex::open(std::string& error, const std::string& indexPath)
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+
+  //Members added before open are merged with the members saved in the index.
+  std::vector<tp_utils::StringID> configuredMembers;
+  std::swap(configuredMembers, d->indexedMembers);
+
+  d->journal.close();
+  d->indexPath.clear();
+  d->entries.clear();
+  d->freeSlots.clear();
+  d->slots.clear();
+  d->members.clear();
+
+  auto fail = [&](const std::string& message)
+  {
+    error = message;
+    d->journal.close();
+    d->indexPath.clear();
+    d->indexedMembers = configuredMembers;
+    d->entries.clear();
+    d->freeSlots.clear();
+    d->slots.clear();
+    d->members.clear();
+    return false;
+  };
+
+  //-- Read the index file -------------------------------------------------------------------------
+  if(tp_utils::exists(indexPath))
+  {
+    std::string data = tp_utils::readBinaryFile(indexPath);
+    nlohmann::json j = nlohmann::json::parse(data, nullptr, false);
+    if(!j.is_object())
+      return fail("Failed to parse dataset index: " + indexPath);
+
+    if(const auto i=j.find("members"); i!=j.end() && i->is_array())
+      for(const auto& name : *i)
+        if(name.is_string())
+          d->addIndexedMember(name.get<std::string>());
+
+    if(const auto i=j.find("collections"); i!=j.end() && i->is_array())
+      for(const auto& collection : *i)
+        d->setEntry(TPJSONString(collection, "key"), valuesFromJSON(collection));
+  }
+
+  //-- Replay the journal --------------------------------------------------------------------------
+  std::string journalPath = indexPath + ".journal";
+  bool truncated=false;
+  {
+    std::ifstream journal(journalPath, std::ios::binary);
+    std::string line;
+    while(std::getline(journal, line))
+    {
+      if(line.empty())
+        continue;
+
+      //A write that was interrupted leaves a partial last line, that update is lost.
+      bool complete = !journal.eof();
+      truncated = !complete;
+      nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+      if(d->applyRecord(j))
+        continue;
+
+      if(complete)
+        return fail("Failed to parse dataset index journal: " + journalPath);
+    }
+  }
+
+  d->journal.open(journalPath, std::ios::binary | std::ios::app);
+  if(!d->journal)
+    return fail("Failed to open dataset index journal: " + journalPath);
+
+  d->indexPath = indexPath;
+
+  for(const auto& name : configuredMembers)
+  {
+    if(d->isIndexed(name.toString()))
+      continue;
+
+    d->indexedMembers.push_back(name);
+
+    nlohmann::json j;
+    j["op"] = "member";
+    j["name"] = name.toString();
+    if(!d->appendJournal(error, j))
+      return fail(error);
+  }
+
+  //New records must not be appended to a partial line.
+  if(truncated && !d->compact(error))
+    return fail(error);
+
+  return true;
+}
+
+//##################################################################################################
+bool DatasetIndex::compact(std::string& error)
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  return d->compact(error);
+}
+
+//##################################################################################################
+bool DatasetIndex::update(std::string& error, const std::string& key, const Collection& collection)
+{
+  return d->update(error, key, collection);
+}
+
+//##################################################################################################
+bool DatasetIndex::updateFromData(std::string& error, const std::string& key, const std::string& data)
+{
+  Collection collection;
+  d->collectionFactory->loadFromData(error, data, collection, d->filter());
+  if(!error.empty())
+    return false;
+
+  return d->update(error, key, collection);
+}
+
+//##################################################################################################
+bool DatasetIndex::updateFromPath(std::string& error, const std::string& path)
+{
+  Collection collection;
+  d->collectionFactory->loadFromPath(error, path, collection, d->filter());
+  if(!error.empty())
+    return false;
+
+  return d->update(error, path, collection);
+}
+
+//##################################################################################################
+bool DatasetIndex::remove(std::string& error, const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  if(d->slots.find(key) == d->slots.end())
+    return true;
+
+  d->removeEntry(key);
+
+  nlohmann::json j;
+  j["op"] = "remove";
+  j["key"] = key;
+  return d->appendJournal(error, j);
+}
+
+//##################################################################################################
+bool DatasetIndex::saveToPath(std::string& error, const Collection& collection, const std::string& path)
+{
+  d->collectionFactory->saveToPath(error, collection, path);
+  if(!error.empty())
+    return false;
+
+  return d->update(error, path, collection);
+}
+
+//##################################################################################################
+bool DatasetIndex::saveToData(std::string& error, const std::string& key, const Collection& collection, std::string& data)
+{
+  d->collectionFactory->saveToData(error, collection, data);
+  if(!error.empty())
+    return false;
+
+  return d->update(error, key, collection);
+}
+
+//##################################################################################################
+bool DatasetIndex::contains(const std::string& key) const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  return d->slots.find(key) != d->slots.end();
+}
+
+//##################################################################################################
+size_t DatasetIndex::size() const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  return d->slots.size();
+}
+
+//##################################################################################################
+std::vector<std::string> DatasetIndex::query(std::string& error, const DatasetQuery& query) const
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+
+  //The slots that match every condition so far, sorted.
+  std::vector<size_t> matches;
+  bool first=true;
+
+  for(const auto& condition : query.conditions())
+  {
+    std::string name = condition.name.toString();
+    if(!d->isIndexed(name))
+    {
+      error = "Member is not indexed: " + name;
+      return {};
+    }
+
+    std::vector<size_t> conditionMatches;
+    if(auto m=d->members.find(name); m!=d->members.end())
+    {
+      const auto& memberIndex = m->second;
+      if(condition.isText)
+      {
+        if(auto t=memberIndex.text.find(condition.text); t!=memberIndex.text.end())
+          conditionMatches.assign(t->second.begin(), t->second.end());
+      }
+      else if(!isEmptyRange(condition))
+      {
+        auto begin = condition.minInclusive?memberIndex.numbers.lower_bound(condition.min):memberIndex.numbers.upper_bound(condition.min);
+        auto end   = condition.maxInclusive?memberIndex.numbers.upper_bound(condition.max):memberIndex.numbers.lower_bound(condition.max);
+        for(auto n=begin; n!=end; ++n)
+          conditionMatches.push_back(n->second);
+        std::sort(conditionMatches.begin(), conditionMatches.end());
+      }
+    }
+
+    if(first)
+      matches = std::move(conditionMatches);
+    else
+    {
+      std::vector<size_t> intersection;
+      std::set_intersection(matches.begin(), matches.end(), conditionMatches.begin(), conditionMatches.end(), std::back_inserter(intersection));
+      matches = std::move(intersection);
+    }
+    first = false;
+
+    if(matches.empty())
+      return {};
+  }
+
+  std::vector<std::string> keys;
+  if(first)
+  {
+    keys.reserve(d->slots.size());
+    for(const auto& s : d->slots)
+      keys.push_back(s.first);
+  }
+  else
+  {
+    keys.reserve(matches.size());
+    for(auto slot : matches)
+      keys.push_back(d->entries.at(slot).key);
+  }
+
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+}
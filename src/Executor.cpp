@@ -0,0 +1,93 @@
+#include "tp_data/Executor.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tp_data
+{
+
+//##################################################################################################
+AbstractExecutor::~AbstractExecutor()=default;
+
+//##################################################################################################
+struct ThreadPoolExecutor::Private
+{
+  std::mutex mutex;
+  std::condition_variable waitCondition;
+  std::deque<std::function<void()>> tasks;
+  bool finish{false};
+  std::vector<std::thread> threads;
+
+  //################################################################################################
+  void run()
+  {
+    for(;;)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        waitCondition.wait(lock, [&]{return finish || !tasks.empty();});
+        if(tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+};
+
+//##################################################################################################
+ThreadPoolExecutor::ThreadPoolExecutor(size_t threadCount):
+  d(new Private())
+{
+  if(threadCount==0)
+    threadCount = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+
+  d->threads.reserve(threadCount);
+  for(size_t i=0; i<threadCount; i++)
+    d->threads.emplace_back([&]{d->run();});
+}
+
+//##################################################################################################
+ThreadPoolExecutor::~ThreadPoolExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->finish = true;
+  }
+  d->waitCondition.notify_all();
+
+  for(auto& thread : d->threads)
+    thread.join();
+
+  delete d;
+}
+
+//##################################################################################################
+size_t ThreadPoolExecutor::threadCount() const
+{
+  return d->threads.size();
+}
+
+//##################################################################################################
+void ThreadPoolExecutor::execute(std::function<void()>&& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->tasks.push_back(std::move(task));
+  }
+  d->waitCondition.notify_one();
+}
+
+//##################################################################################################
+void InlineExecutor::execute(std::function<void()>&& task)
+{
+  task();
+}
+
+}
@@ -0,0 +1,240 @@
+#include "tp_data/FactoryCounters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace tp_data
+{
+
+namespace
+{
+constexpr size_t operationCount=3;
+
+//##################################################################################################
+//! Only the owning thread adds to these but reset() can zero them from any thread, so updates are
+//! atomic read-modify-writes rather than a load then a store that could undo a reset.
+struct AtomicOperationCounters
+{
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> errors{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> totalNS{0};
+  std::atomic<uint64_t> maxNS{0};
+
+  //################################################################################################
+  void record(uint64_t c, uint64_t b, uint64_t ns, bool error)
+  {
+    calls  .fetch_add(c, std::memory_order_relaxed);
+    errors .fetch_add(error?1:0, std::memory_order_relaxed);
+    bytes  .fetch_add(b, std::memory_order_relaxed);
+    totalNS.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = maxNS.load(std::memory_order_relaxed);
+    while(ns>max && !maxNS.compare_exchange_weak(max, ns, std::memory_order_relaxed));
+  }
+
+  //################################################################################################
+  void addTo(OperationCounters& output) const
+  {
+    output.calls   += calls  .load(std::memory_order_relaxed);
+    output.errors  += errors .load(std::memory_order_relaxed);
+    output.bytes   += bytes  .load(std::memory_order_relaxed);
+    output.totalNS += totalNS.load(std::memory_order_relaxed);
+    output.maxNS = std::max(output.maxNS, maxNS.load(std::memory_order_relaxed));
+  }
+
+  //################################################################################################
+  void reset()
+  {
+    calls  .store(0, std::memory_order_relaxed);
+    errors .store(0, std::memory_order_relaxed);
+    bytes  .store(0, std::memory_order_relaxed);
+    totalNS.store(0, std::memory_order_relaxed);
+    maxNS  .store(0, std::memory_order_relaxed);
+  }
+};
+
+//##################################################################################################
+struct ThreadCounters
+{
+  size_t size;
+  std::unique_ptr<AtomicOperationCounters[]> counters;
+
+  //################################################################################################
+  ThreadCounters(size_t typeCount):
+    size(typeCount*operationCount),
+    counters(new AtomicOperationCounters[size])
+  {
+
+  }
+};
+
+//##################################################################################################
+uint64_t nextCountersID()
+{
+  static std::atomic<uint64_t> id{0};
+  return ++id;
+}
+}
+
+//##################################################################################################
+struct FactoryCounters::Private
+{
+  //Identifies this object in the thread local lookup, the address could be reused.
+  const uint64_t id{nextCountersID()};
+  std::atomic<bool> enabled{false};
+  std::vector<tp_utils::StringID> types;
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadCounters>> threads;
+
+  //################################################################################################
+  ThreadCounters& local()
+  {
+    //The blocks are owned by threads above, once a FactoryCounters is destroyed its entries expire
+    //and are removed here so that a thread doesn't accumulate entries for every factory it used.
+    struct LocalBlock
+    {
+      uint64_t id;
+      ThreadCounters* counters;
+      std::weak_ptr<ThreadCounters> owner;
+    };
+
+    thread_local std::vector<LocalBlock> blocks;
+    for(auto i=blocks.begin(); i!=blocks.end();)
+    {
+      //This object owns its own blocks so the pointer is valid without locking the weak_ptr.
+      if(i->id == id)
+        return *i->counters;
+
+      if(i->owner.expired())
+        i = blocks.erase(i);
+      else
+        ++i;
+    }
+
+    auto block = std::make_shared<ThreadCounters>(types.size());
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.push_back(block);
+    }
+    blocks.push_back({id, block.get(), block});
+    return *block;
+  }
+};
+
+//##################################################################################################
+nlohmann::json OperationCounters::toJSON() const
+{
+  nlohmann::json j;
+  j["calls"]    = calls;
+  j["errors"]   = errors;
+  j["bytes"]    = bytes;
+  j["total_ns"] = totalNS;
+  j["max_ns"]   = maxNS;
+  return j;
+}
+
+//##################################################################################################
+nlohmann::json MemberTypeCounters::toJSON() const
+{
+  nlohmann::json j;
+  j["type"]  = type.toString();
+  j["save"]  = save.toJSON();
+  j["load"]  = load.toJSON();
+  j["clone"] = clone.toJSON();
+  return j;
+}
+
+//##################################################################################################
+FactoryCounters::FactoryCounters():
+  d(new Private())
+{
+
+}
+
+//##################################################################################################
+FactoryCounters::~FactoryCounters()
+{
+  delete d;
+}
+
+//##################################################################################################
+void FactoryCounters::setEnabled(bool enabled)
+{
+  d->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+//##################################################################################################
+bool FactoryCounters::enabled() const
+{
+  return d->enabled.load(std::memory_order_relaxed);
+}
+
+//##################################################################################################
+void FactoryCounters::reset()
+{
+  std::lock_guard<std::mutex> lock(d->mutex);
+  for(const auto& thread : d->threads)
+    for(size_t i=0; i<thread->size; i++)
+      thread->counters[i].reset();
+}
+
+//##################################################################################################
+void FactoryCounters::setTypes(const std::vector<tp_utils::StringID>& types)
+{
+  d->types = types;
+}
+
+//##################################################################################################
+void FactoryCounters::record(size_t typeIndex,
+                             CountedOperation operation,
+                             uint64_t calls,
+                             uint64_t bytes,
+                             uint64_t ns,
+                             bool error) const
+{
+  if(typeIndex>=d->types.size())
+    return;
+
+  auto& thread = d->local();
+  size_t i = typeIndex*operationCount + size_t(operation);
+  if(i<thread.size)
+    thread.counters[i].record(calls, bytes, ns, error);
+}
+
+//##################################################################################################
+std::vector<MemberTypeCounters> FactoryCounters::snapshot() const
+{
+  std::vector<MemberTypeCounters> result(d->types.size());
+  for(size_t t=0; t<result.size(); t++)
+    result[t].type = d->types.at(t);
+
+  std::lock_guard<std::mutex> lock(d->mutex);
+  for(const auto& thread : d->threads)
+  {
+    for(size_t t=0; t<result.size() && (t+1)*operationCount<=thread->size; t++)
+    {
+      auto c = thread->counters.get() + t*operationCount;
+      c[size_t(CountedOperation::Save )].addTo(result[t].save);
+      c[size_t(CountedOperation::Load )].addTo(result[t].load);
+      c[size_t(CountedOperation::Clone)].addTo(result[t].clone);
+    }
+  }
+
+  return result;
+}
+
+//##################################################################################################
+nlohmann::json FactoryCounters::snapshotJSON() const
+{
+  nlohmann::json j = nlohmann::json::array();
+  for(const auto& counters : snapshot())
+    if(counters.save.calls || counters.load.calls || counters.clone.calls)
+      j.push_back(counters.toJSON());
+  return j;
+}
+
+}
@@ -4,6 +4,10 @@
 #include "tp_data/members/StringMember.h"
 #include "tp_data/members/StringIDVectorMember.h"
 #include "tp_data/members/NumberMember.h"
+#include "tp_data/members/NumberVectorMember.h"
+#include "tp_data/members/TensorMember.h"
+#include "tp_data/members/ImageMember.h"
+#include "tp_data/members/BytesMember.h"
 
 //##################################################################################################
 namespace tp_data
@@ -14,7 +18,17 @@ TP_DEFINE_ID(                          intSID,                              "Int
 TP_DEFINE_ID(                        sizeTSID,                           "Size t");
 TP_DEFINE_ID(                        floatSID,                            "Float");
 TP_DEFINE_ID(                       doubleSID,                           "Double");
+TP_DEFINE_ID(                        int64SID,                            "Int64");
+TP_DEFINE_ID(                       uint64SID,                           "UInt64");
 TP_DEFINE_ID(               stringIDVectorSID,                 "String id vector");
+TP_DEFINE_ID(                  floatVectorSID,                   "Float vector");
+TP_DEFINE_ID(                 doubleVectorSID,                  "Double vector");
+TP_DEFINE_ID(                  int32VectorSID,                   "Int32 vector");
+TP_DEFINE_ID(                  int64VectorSID,                   "Int64 vector");
+TP_DEFINE_ID(                  uint8VectorSID,                   "UInt8 vector");
+TP_DEFINE_ID(                       tensorSID,                         "Tensor");
+TP_DEFINE_ID(                        imageSID,                          "Image");
+TP_DEFINE_ID(                        bytesSID,                          "Bytes");
 
 //##################################################################################################
 void createCollectionFactories(CollectionFactory& collectionFactory)
@@ -27,6 +41,18 @@ void createCollectionFactories(CollectionFactory& collectionFactory)
   collectionFactory.addMemberFactory(new  SizeTMemberFactory({166, 63, 148}));
   collectionFactory.addMemberFactory(new  FloatMemberFactory({163, 31, 140}));
   collectionFactory.addMemberFactory(new DoubleMemberFactory({212, 11, 177}));
+  collectionFactory.addMemberFactory(new  Int64MemberFactory({190, 80, 170}));
+  collectionFactory.addMemberFactory(new UInt64MemberFactory({150, 40, 130}));
+
+  collectionFactory.addMemberFactory(new  FloatVectorMemberFactory({135, 86, 201}));
+  collectionFactory.addMemberFactory(new DoubleVectorMemberFactory({116, 62, 184}));
+  collectionFactory.addMemberFactory(new  Int32VectorMemberFactory({181, 106, 214}));
+  collectionFactory.addMemberFactory(new  Int64VectorMemberFactory({157, 81, 196}));
+  collectionFactory.addMemberFactory(new  UInt8VectorMemberFactory({201, 134, 224}));
+
+  collectionFactory.addMemberFactory(new TensorMemberFactory({96, 48, 168}));
+  collectionFactory.addMemberFactory(new  ImageMemberFactory({235, 160, 52}));
+  collectionFactory.addMemberFactory(new  BytesMemberFactory({120, 120, 120}));
 }
 
 //##################################################################################################
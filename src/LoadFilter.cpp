@@ -0,0 +1,76 @@
+#include "tp_data/LoadFilter.h"
+
+namespace tp_data
+{
+
+//##################################################################################################
+LoadFilter::LoadFilter(const std::vector<std::string>& names)
+{
+  addNames(names);
+}
+
+//##################################################################################################
+LoadFilter& LoadFilter::addName(const std::string& name)
+{
+  m_names.insert(name);
+  return *this;
+}
+
+//##################################################################################################
+LoadFilter& LoadFilter::addNames(const std::vector<std::string>& names)
+{
+  m_names.reserve(m_names.size()+names.size());
+  for(const auto& name : names)
+    m_names.insert(name);
+  return *this;
+}
+
+//##################################################################################################
+LoadFilter& LoadFilter::addType(const tp_utils::StringID& type)
+{
+  m_types.insert(type.keyString());
+  return *this;
+}
+
+//##################################################################################################
+LoadFilter& LoadFilter::setTimestampRange(int64_t minMS, int64_t maxMS)
+{
+  m_minTimestampMS = minMS;
+  m_maxTimestampMS = maxMS;
+  return *this;
+}
+
+//##################################################################################################
+bool LoadFilter::acceptsAll() const
+{
+  return m_names.empty() &&
+      m_types.empty() &&
+      m_minTimestampMS == std::numeric_limits<int64_t>::min() &&
+      m_maxTimestampMS == std::numeric_limits<int64_t>::max();
+}
+
+//##################################################################################################
+bool LoadFilter::acceptsName(const std::string& name) const
+{
+  return m_names.empty() || m_names.find(name) != m_names.end();
+}
+
+//##################################################################################################
+bool LoadFilter::acceptsType(const std::string& type) const
+{
+  return m_types.empty() || m_types.find(type) != m_types.end();
+}
+
+//##################################################################################################
+bool LoadFilter::acceptsTimestamp(int64_t timestampMS) const
+{
+  return timestampMS>=m_minTimestampMS && timestampMS<=m_maxTimestampMS;
+}
+
+//##################################################################################################
+bool LoadFilter::accepts(const std::string& name, const std::string& type, int64_t timestampMS) const
+{
+  return acceptsTimestamp(timestampMS) && acceptsType(type) && acceptsName(name);
+}
+
+}
@@ -0,0 +1,227 @@
+#include "tp_data/SharedBuffer.h"
+#include "tp_data/AlignedAllocator.h"
+
+#include "tp_utils/FileUtils.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace tp_data
+{
+
+namespace
+{
+
+//##################################################################################################
+struct MappedFile
+{
+  TP_NONCOPYABLE(MappedFile);
+  const char* data{nullptr};
+  size_t size{0};
+
+#ifdef _WIN32
+  HANDLE file{INVALID_HANDLE_VALUE};
+  HANDLE mapping{nullptr};
+#endif
+
+  //################################################################################################
+  MappedFile()=default;
+
+  //################################################################################################
+  ~MappedFile()
+  {
+#ifdef _WIN32
+    if(data)
+      UnmapViewOfFile(data);
+    if(mapping)
+      CloseHandle(mapping);
+    if(file != INVALID_HANDLE_VALUE)
+      CloseHandle(file);
+#else
+    if(data)
+      munmap(const_cast<char*>(data), size);
+#endif
+  }
+
+  //################################################################################################
+  bool map(const std::string& path)
+  {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize))
+      return false;
+
+    size = size_t(fileSize.QuadPart);
+    if(size==0)
+      return true;
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping)
+      return false;
+
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    return data!=nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd<0)
+      return false;
+
+    struct stat s;
+    if(fstat(fd, &s)!=0)
+    {
+      close(fd);
+      return false;
+    }
+
+    size = size_t(s.st_size);
+    if(size==0)
+    {
+      close(fd);
+      return true;
+    }
+
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(ptr == MAP_FAILED)
+      return false;
+
+    data = static_cast<const char*>(ptr);
+    return true;
+#endif
+  }
+};
+
+}
+
+//##################################################################################################
+SharedBuffer::SharedBuffer() = default;
+
+//##################################################################################################
+SharedBuffer SharedBuffer::fromString(std::string&& data)
+{
+  auto owner = std::make_shared<std::string>(std::move(data));
+
+  SharedBuffer buffer;
+  buffer.m_data = owner->data();
+  buffer.m_size = owner->size();
+  buffer.m_owner = std::move(owner);
+  return buffer;
+}
+
+//##################################################################################################
+SharedBuffer SharedBuffer::copy(const void* data, size_t size)
+{
+  SharedBuffer buffer = allocate(size);
+  if(size>0)
+    memcpy(buffer.mutableData(), data, size);
+  return buffer;
+}
+
+//##################################################################################################
+SharedBuffer SharedBuffer::allocate(size_t size)
+{
+  auto owner = std::make_shared<AlignedVector<char>>(size, 0);
+
+  SharedBuffer buffer;
+  buffer.m_data = owner->data();
+  buffer.m_size = owner->size();
+  buffer.m_owner = std::move(owner);
+  buffer.m_writable = true;
+  return buffer;
+}
+
+//##################################################################################################
+SharedBuffer SharedBuffer::mapFile(std::string& error, const std::string& path)
+{
+  auto owner = std::make_shared<MappedFile>();
+  if(!owner->map(path))
+  {
+    if(!tp_utils::exists(path))
+    {
+      error = "Failed to open file: " + path;
+      return SharedBuffer();
+    }
+
+    return fromString(tp_utils::readBinaryFile(path));
+  }
+
+  SharedBuffer buffer;
+  buffer.m_data = owner->data;
+  buffer.m_size = owner->size;
+  buffer.m_owner = std::move(owner);
+  return buffer;
+}
+
+//##################################################################################################
+const char* SharedBuffer::data() const
+{
+  return m_data;
+}
+
+//##################################################################################################
+size_t SharedBuffer::size() const
+{
+  return m_size;
+}
+
+//##################################################################################################
+bool SharedBuffer::empty() const
+{
+  return m_size==0;
+}
+
+//##################################################################################################
+std::string_view SharedBuffer::view() const
+{
+  return std::string_view(m_data, m_size);
+}
+
+//##################################################################################################
+std::string SharedBuffer::toString() const
+{
+  return std::string(m_data, m_size);
+}
+
+//##################################################################################################
+SharedBuffer SharedBuffer::slice(size_t offset, size_t size) const
+{
+  offset = std::min(offset, m_size);
+  size = std::min(size, m_size-offset);
+
+  SharedBuffer buffer;
+  buffer.m_owner = m_owner;
+  buffer.m_data = m_data + offset;
+  buffer.m_size = size;
+  return buffer;
+}
+
+//##################################################################################################
+char* SharedBuffer::mutableData()
+{
+  if(!m_writable || m_owner.use_count()!=1)
+    return nullptr;
+
+  return const_cast<char*>(m_data);
+}
+
+//##################################################################################################
+const std::shared_ptr<const void>& SharedBuffer::owner() const
+{
+  return m_owner;
+}
+
+}
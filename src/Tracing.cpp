@@ -0,0 +1,157 @@
+#include "tp_data/Tracing.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace tp_data
+{
+
+namespace
+{
+//##################################################################################################
+struct Event
+{
+  const char* name;
+  std::string member;
+  std::string type;
+  size_t bytes;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+};
+
+//##################################################################################################
+//! The events of one thread, the mutex is only contended while the trace is being read.
+struct ThreadEvents
+{
+  size_t tid{0};
+  std::mutex mutex;
+  std::vector<Event> events;
+};
+
+//##################################################################################################
+struct TraceState
+{
+  std::atomic<bool> recording{false};
+  std::chrono::steady_clock::time_point epoch{std::chrono::steady_clock::now()};
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadEvents>> threads;
+};
+
+//##################################################################################################
+TraceState& traceState()
+{
+  static TraceState traceState;
+  return traceState;
+}
+
+//##################################################################################################
+ThreadEvents& localEvents()
+{
+  thread_local std::shared_ptr<ThreadEvents> local;
+  if(!local)
+  {
+    local = std::make_shared<ThreadEvents>();
+    auto& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    local->tid = state.threads.size()+1;
+    state.threads.push_back(local);
+  }
+  return *local;
+}
+}
+
+//##################################################################################################
+void TraceRecorder::start()
+{
+  auto& state = traceState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  for(const auto& thread : state.threads)
+  {
+    std::lock_guard<std::mutex> threadLock(thread->mutex);
+    thread->events.clear();
+  }
+  state.epoch = std::chrono::steady_clock::now();
+  state.recording = true;
+}
+
+//##################################################################################################
+void TraceRecorder::stop()
+{
+  traceState().recording = false;
+}
+
+//##################################################################################################
+bool TraceRecorder::recording()
+{
+  return traceState().recording.load(std::memory_order_relaxed);
+}
+
+//##################################################################################################
+nlohmann::json TraceRecorder::chromeTrace()
+{
+  auto& state = traceState();
+
+  nlohmann::json traceEvents = nlohmann::json::array();
+  auto toUS = [&](std::chrono::steady_clock::time_point t)
+  {
+    return std::chrono::duration<double, std::micro>(t-state.epoch).count();
+  };
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+  for(const auto& thread : state.threads)
+  {
+    std::lock_guard<std::mutex> threadLock(thread->mutex);
+    for(const auto& event : thread->events)
+    {
+      nlohmann::json j;
+      j["name"] = event.name;
+      j["cat"]  = "tp_data";
+      j["ph"]   = "X";
+      j["ts"]   = toUS(event.start);
+      j["dur"]  = toUS(event.end) - toUS(event.start);
+      j["pid"]  = 1;
+      j["tid"]  = thread->tid;
+
+      auto& args = j["args"];
+      args = nlohmann::json::object();
+      if(!event.member.empty())
+        args["member"] = event.member;
+      if(!event.type.empty())
+        args["type"] = event.type;
+      if(event.bytes)
+        args["bytes"] = event.bytes;
+
+      traceEvents.push_back(std::move(j));
+    }
+  }
+
+  nlohmann::json j;
+  j["traceEvents"] = std::move(traceEvents);
+  j["displayTimeUnit"] = "ms";
+  return j;
+}
+
+//##################################################################################################
+bool TraceRecorder::writeChromeTrace(const std::string& path)
+{
+  return tp_utils::writeJSONFile(path, chromeTrace());
+}
+
+//##################################################################################################
+void TraceRecorder::addEvent(const char* name,
+                             std::string&& member,
+                             std::string&& type,
+                             size_t bytes,
+                             std::chrono::steady_clock::time_point start,
+                             std::chrono::steady_clock::time_point end)
+{
+  auto& thread = localEvents();
+  std::lock_guard<std::mutex> lock(thread.mutex);
+  thread.events.push_back({name, std::move(member), std::move(type), bytes, start, end});
+}
+
+}
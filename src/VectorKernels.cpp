@@ -0,0 +1,337 @@
+#include "tp_data/VectorKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define TP_DATA_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#  define TP_DATA_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace tp_data
+{
+
+namespace
+{
+
+//##################################################################################################
+template<typename T>
+T scalarMin(const T* data, size_t count, T m)
+{
+  for(size_t i=0; i<count; i++)
+    m = (data[i]<m)?data[i]:m;
+  return m;
+}
+
+//##################################################################################################
+template<typename T>
+T scalarMax(const T* data, size_t count, T m)
+{
+  for(size_t i=0; i<count; i++)
+    m = (data[i]>m)?data[i]:m;
+  return m;
+}
+
+#ifdef TP_DATA_SSE2
+//##################################################################################################
+float horizontalSum(__m128 v)
+{
+  alignas(16) float t[4];
+  _mm_store_ps(t, v);
+  return (t[0]+t[1]) + (t[2]+t[3]);
+}
+
+//##################################################################################################
+double horizontalSum(__m128d v)
+{
+  alignas(16) double t[2];
+  _mm_store_pd(t, v);
+  return t[0]+t[1];
+}
+
+//##################################################################################################
+__m128i selectMin(__m128i a, __m128i b)
+{
+  __m128i mask = _mm_cmplt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+//##################################################################################################
+__m128i selectMax(__m128i a, __m128i b)
+{
+  __m128i mask = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+}
+
+//##################################################################################################
+float vectorSum(const float* data, size_t count)
+{
+  size_t i=0;
+  float s=0.0f;
+#if defined(TP_DATA_SSE2)
+  __m128 a0 = _mm_setzero_ps();
+  __m128 a1 = _mm_setzero_ps();
+  for(; i+8<=count; i+=8)
+  {
+    a0 = _mm_add_ps(a0, _mm_loadu_ps(data+i));
+    a1 = _mm_add_ps(a1, _mm_loadu_ps(data+i+4));
+  }
+  s = horizontalSum(_mm_add_ps(a0, a1));
+#elif defined(TP_DATA_NEON)
+  float32x4_t a0 = vdupq_n_f32(0.0f);
+  for(; i+4<=count; i+=4)
+    a0 = vaddq_f32(a0, vld1q_f32(data+i));
+  s = (vgetq_lane_f32(a0, 0)+vgetq_lane_f32(a0, 1)) + (vgetq_lane_f32(a0, 2)+vgetq_lane_f32(a0, 3));
+#endif
+  return s + vectorSum<float>(data+i, count-i);
+}
+
+//##################################################################################################
+float vectorMin(const float* data, size_t count)
+{
+  if(count==0)
+    return 0.0f;
+
+  size_t i=0;
+  float m=data[0];
+#if defined(TP_DATA_SSE2)
+  if(count>=4)
+  {
+    __m128 v = _mm_loadu_ps(data);
+    for(i=4; i+4<=count; i+=4)
+      v = _mm_min_ps(v, _mm_loadu_ps(data+i));
+    alignas(16) float t[4];
+    _mm_store_ps(t, v);
+    m = scalarMin(t, 4, t[0]);
+  }
+#elif defined(TP_DATA_NEON)
+  if(count>=4)
+  {
+    float32x4_t v = vld1q_f32(data);
+    for(i=4; i+4<=count; i+=4)
+      v = vminq_f32(v, vld1q_f32(data+i));
+    float t[4];
+    vst1q_f32(t, v);
+    m = scalarMin(t, 4, t[0]);
+  }
+#endif
+  return scalarMin(data+i, count-i, m);
+}
+
+//##################################################################################################
+float vectorMax(const float* data, size_t count)
+{
+  if(count==0)
+    return 0.0f;
+
+  size_t i=0;
+  float m=data[0];
+#if defined(TP_DATA_SSE2)
+  if(count>=4)
+  {
+    __m128 v = _mm_loadu_ps(data);
+    for(i=4; i+4<=count; i+=4)
+      v = _mm_max_ps(v, _mm_loadu_ps(data+i));
+    alignas(16) float t[4];
+    _mm_store_ps(t, v);
+    m = scalarMax(t, 4, t[0]);
+  }
+#elif defined(TP_DATA_NEON)
+  if(count>=4)
+  {
+    float32x4_t v = vld1q_f32(data);
+    for(i=4; i+4<=count; i+=4)
+      v = vmaxq_f32(v, vld1q_f32(data+i));
+    float t[4];
+    vst1q_f32(t, v);
+    m = scalarMax(t, 4, t[0]);
+  }
+#endif
+  return scalarMax(data+i, count-i, m);
+}
+
+//##################################################################################################
+float vectorDot(const float* a, const float* b, size_t count)
+{
+  size_t i=0;
+  float s=0.0f;
+#if defined(TP_DATA_SSE2)
+  __m128 a0 = _mm_setzero_ps();
+  __m128 a1 = _mm_setzero_ps();
+  for(; i+8<=count; i+=8)
+  {
+    a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(a+i  ), _mm_loadu_ps(b+i  )));
+    a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(a+i+4), _mm_loadu_ps(b+i+4)));
+  }
+  s = horizontalSum(_mm_add_ps(a0, a1));
+#elif defined(TP_DATA_NEON)
+  float32x4_t a0 = vdupq_n_f32(0.0f);
+  for(; i+4<=count; i+=4)
+    a0 = vmlaq_f32(a0, vld1q_f32(a+i), vld1q_f32(b+i));
+  s = (vgetq_lane_f32(a0, 0)+vgetq_lane_f32(a0, 1)) + (vgetq_lane_f32(a0, 2)+vgetq_lane_f32(a0, 3));
+#endif
+  return s + vectorDot<float>(a+i, b+i, count-i);
+}
+
+//##################################################################################################
+double vectorSum(const double* data, size_t count)
+{
+  size_t i=0;
+  double s=0.0;
+#if defined(TP_DATA_SSE2)
+  __m128d a0 = _mm_setzero_pd();
+  __m128d a1 = _mm_setzero_pd();
+  for(; i+4<=count; i+=4)
+  {
+    a0 = _mm_add_pd(a0, _mm_loadu_pd(data+i));
+    a1 = _mm_add_pd(a1, _mm_loadu_pd(data+i+2));
+  }
+  s = horizontalSum(_mm_add_pd(a0, a1));
+#endif
+  return s + vectorSum<double>(data+i, count-i);
+}
+
+//##################################################################################################
+double vectorMin(const double* data, size_t count)
+{
+  if(count==0)
+    return 0.0;
+
+  size_t i=0;
+  double m=data[0];
+#if defined(TP_DATA_SSE2)
+  if(count>=2)
+  {
+    __m128d v = _mm_loadu_pd(data);
+    for(i=2; i+2<=count; i+=2)
+      v = _mm_min_pd(v, _mm_loadu_pd(data+i));
+    alignas(16) double t[2];
+    _mm_store_pd(t, v);
+    m = scalarMin(t, 2, t[0]);
+  }
+#endif
+  return scalarMin(data+i, count-i, m);
+}
+
+//##################################################################################################
+double vectorMax(const double* data, size_t count)
+{
+  if(count==0)
+    return 0.0;
+
+  size_t i=0;
+  double m=data[0];
+#if defined(TP_DATA_SSE2)
+  if(count>=2)
+  {
+    __m128d v = _mm_loadu_pd(data);
+    for(i=2; i+2<=count; i+=2)
+      v = _mm_max_pd(v, _mm_loadu_pd(data+i));
+    alignas(16) double t[2];
+    _mm_store_pd(t, v);
+    m = scalarMax(t, 2, t[0]);
+  }
+#endif
+  return scalarMax(data+i, count-i, m);
+}
+
+//##################################################################################################
+double vectorDot(const double* a, const double* b, size_t count)
+{
+  size_t i=0;
+  double s=0.0;
+#if defined(TP_DATA_SSE2)
+  __m128d a0 = _mm_setzero_pd();
+  __m128d a1 = _mm_setzero_pd();
+  for(; i+4<=count; i+=4)
+  {
+    a0 = _mm_add_pd(a0, _mm_mul_pd(_mm_loadu_pd(a+i  ), _mm_loadu_pd(b+i  )));
+    a1 = _mm_add_pd(a1, _mm_mul_pd(_mm_loadu_pd(a+i+2), _mm_loadu_pd(b+i+2)));
+  }
+  s = horizontalSum(_mm_add_pd(a0, a1));
+#endif
+  return s + vectorDot<double>(a+i, b+i, count-i);
+}
+
+//##################################################################################################
+int64_t vectorSum(const int32_t* data, size_t count)
+{
+  //Integer sums are widened to 64 bit which SSE2 can't do efficiently, the portable version is
+  //vectorized by the compiler.
+  return vectorSum<int32_t>(data, count);
+}
+
+//##################################################################################################
+int32_t vectorMin(const int32_t* data, size_t count)
+{
+  if(count==0)
+    return 0;
+
+  size_t i=0;
+  int32_t m=data[0];
+#if defined(TP_DATA_SSE2)
+  if(count>=4)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    for(i=4; i+4<=count; i+=4)
+      v = selectMin(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)));
+    alignas(16) int32_t t[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(t), v);
+    m = scalarMin(t, 4, t[0]);
+  }
+#elif defined(TP_DATA_NEON)
+  if(count>=4)
+  {
+    int32x4_t v = vld1q_s32(data);
+    for(i=4; i+4<=count; i+=4)
+      v = vminq_s32(v, vld1q_s32(data+i));
+    int32_t t[4];
+    vst1q_s32(t, v);
+    m = scalarMin(t, 4, t[0]);
+  }
+#endif
+  return scalarMin(data+i, count-i, m);
+}
+
+//##################################################################################################
+int32_t vectorMax(const int32_t* data, size_t count)
+{
+  if(count==0)
+    return 0;
+
+  size_t i=0;
+  int32_t m=data[0];
+#if defined(TP_DATA_SSE2)
+  if(count>=4)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    for(i=4; i+4<=count; i+=4)
+      v = selectMax(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)));
+    alignas(16) int32_t t[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(t), v);
+    m = scalarMax(t, 4, t[0]);
+  }
+#elif defined(TP_DATA_NEON)
+  if(count>=4)
+  {
+    int32x4_t v = vld1q_s32(data);
+    for(i=4; i+4<=count; i+=4)
+      v = vmaxq_s32(v, vld1q_s32(data+i));
+    int32_t t[4];
+    vst1q_s32(t, v);
+    m = scalarMax(t, 4, t[0]);
+  }
+#endif
+  return scalarMax(data+i, count-i, m);
+}
+
+//##################################################################################################
+int64_t vectorDot(const int32_t* a, const int32_t* b, size_t count)
+{
+  return vectorDot<int32_t>(a, b, count);
+}
+
+}
@@ -0,0 +1,119 @@
+#include "tp_data/members/BytesMember.h"
+
+namespace tp_data
+{
+const std::string BytesMember::extension{"bin"};
+
+//##################################################################################################
+BytesMember::BytesMember(const tp_utils::StringID& name, const SharedBuffer& data_):
+  AbstractMember(name, bytesSID())
+{
+  data = data_;
+}
+
+//##################################################################################################
+BytesMember::~BytesMember() = default;
+
+//##################################################################################################
+std::shared_ptr<BytesMember> BytesMember::slice(size_t offset, size_t size) const
+{
+  return std::make_shared<BytesMember>(name(), data.slice(offset, size));
+}
+
+//##################################################################################################
+BytesMember* BytesMember::fromData(std::string& error, std::string_view data)
+{
+  TP_UNUSED(error);
+  return new BytesMember(tp_utils::StringID(), SharedBuffer::copy(data.data(), data.size()));
+}
+
+//##################################################################################################
+std::string BytesMember::toData() const
+{
+  return data.toString();
+}
+
+//##################################################################################################
+void BytesMember::appendData(std::string& output) const
+{
+  output.append(data.data(), data.size());
+}
+
+//##################################################################################################
+void BytesMember::copyData(const BytesMember& other)
+{
+  data = other.data;
+}
+
+//##################################################################################################
+size_t BytesMember::memoryUsage() const
+{
+  return sizeof(BytesMember) + data.size();
+}
+
+//##################################################################################################
+BytesMemberFactory::BytesMemberFactory(TPPixel color):
+  AbstractMemberFactory(bytesSID(), BytesMember::extension, color)
+{
+
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> BytesMemberFactory::clone(std::string& error, const AbstractMember& member) const
+{
+  auto m = dynamic_cast<const BytesMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return nullptr;
+  }
+
+  return std::make_shared<BytesMember>(tp_utils::StringID(), m->data);
+}
+
+//##################################################################################################
+void BytesMemberFactory::save(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  data.clear();
+  saveAppend(error, member, data);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> BytesMemberFactory::load(std::string& error, const std::string& data) const
+{
+  return loadView(error, data);
+}
+
+//##################################################################################################
+void BytesMemberFactory::saveAppend(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  auto m = dynamic_cast<const BytesMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return;
+  }
+
+  m->appendData(data);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> BytesMemberFactory::loadView(std::string& error, std::string_view data) const
+{
+  return std::shared_ptr<AbstractMember>(BytesMember::fromData(error, data));
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> BytesMemberFactory::loadShared(std::string& error, const SharedBuffer& data) const
+{
+  TP_UNUSED(error);
+  return std::make_shared<BytesMember>(tp_utils::StringID(), data);
+}
+
+//##################################################################################################
+bool BytesMemberFactory::sharesLoadedData() const
+{
+  return true;
+}
+
+}
@@ -0,0 +1,481 @@
+#include "tp_data/members/ImageMember.h"
+#include "tp_data/BinaryUtils.h"
+#include "tp_data/MemoryUsage.h"
+
+#include <limits>
+
+namespace tp_data
+{
+const std::string ImageMember::extension{"tpim"};
+
+namespace
+{
+static_assert(sizeof(TPPixel)==4, "ImageMember expects 4 byte RGBA pixels.");
+
+constexpr uint8_t formatVersion=1;
+constexpr size_t fixedHeaderSize=24;
+constexpr size_t defaultBandHeight=16;
+
+//! The most bytes that runLengthDecode can produce from each input byte, a 2 byte run gives 128.
+constexpr size_t maxRunLengthExpansion=64;
+
+//##################################################################################################
+template<typename T>
+void appendValue(std::string& output, T value)
+{
+  appendLittleEndian(output, &value, 1);
+}
+
+//##################################################################################################
+template<typename T>
+T readValue(const char* input)
+{
+  T value;
+  readLittleEndian(input, &value, 1);
+  return value;
+}
+
+//##################################################################################################
+//! PackBits style run length encoding.
+void runLengthEncode(const uint8_t* input, size_t size, std::string& output)
+{
+  size_t i=0;
+  while(i<size)
+  {
+    size_t run=1;
+    while(i+run<size && run<128 && input[i+run]==input[i])
+      run++;
+
+    if(run>=3)
+    {
+      output.push_back(char(257-run));
+      output.push_back(char(input[i]));
+      i+=run;
+      continue;
+    }
+
+    size_t start=i;
+    while(i<size && (i-start)<128)
+    {
+      if(i+2<size && input[i]==input[i+1] && input[i]==input[i+2])
+        break;
+      i++;
+    }
+
+    output.push_back(char(i-start-1));
+    output.append(reinterpret_cast<const char*>(input+start), i-start);
+  }
+}
+
+//##################################################################################################
+bool runLengthDecode(const uint8_t* input, size_t size, uint8_t* output, size_t outputSize)
+{
+  size_t i=0;
+  size_t o=0;
+  while(i<size)
+  {
+    uint8_t c = input[i];
+    i++;
+
+    if(c<128)
+    {
+      size_t count = size_t(c)+1;
+      if(i+count>size || o+count>outputSize)
+        return false;
+      memcpy(output+o, input+i, count);
+      i+=count;
+      o+=count;
+    }
+    else if(c>128)
+    {
+      size_t count = 257-size_t(c);
+      if(i>=size || o+count>outputSize)
+        return false;
+      memset(output+o, input[i], count);
+      i++;
+      o+=count;
+    }
+  }
+
+  return o==outputSize;
+}
+
+//##################################################################################################
+//! Replace each byte with its difference from the byte it is predicted from.
+void predictBand(const uint8_t* pixels, size_t rowBytes, size_t rows, std::vector<uint8_t>& residuals)
+{
+  residuals.resize(rowBytes*rows);
+
+  for(size_t i=0; i<rowBytes && i<4; i++)
+    residuals[i] = pixels[i];
+  for(size_t i=4; i<rowBytes; i++)
+    residuals[i] = uint8_t(pixels[i] - pixels[i-4]);
+
+  for(size_t i=rowBytes; i<rowBytes*rows; i++)
+    residuals[i] = uint8_t(pixels[i] - pixels[i-rowBytes]);
+}
+
+//##################################################################################################
+//! Reverse predictBand in place.
+void unpredictBand(uint8_t* pixels, size_t rowBytes, size_t rows)
+{
+  for(size_t i=4; i<rowBytes; i++)
+    pixels[i] = uint8_t(pixels[i] + pixels[i-4]);
+
+  for(size_t i=rowBytes; i<rowBytes*rows; i++)
+    pixels[i] = uint8_t(pixels[i] + pixels[i-rowBytes]);
+}
+
+//##################################################################################################
+struct Header
+{
+  ImageCompression compression{ImageCompression::None};
+  size_t bandHeight{0};
+  size_t width{0};
+  size_t height{0};
+  size_t bandCount{0};
+  const char* offsets{nullptr};
+  const char* bands{nullptr};
+  size_t bandsSize{0};
+
+  //################################################################################################
+  bool parse(std::string& error, const char* data, size_t size)
+  {
+    if(size<fixedHeaderSize || memcmp(data, "TPIM", 4)!=0)
+    {
+      error = "Invalid image header.";
+      return false;
+    }
+
+    if(uint8_t(data[4]) != formatVersion)
+    {
+      error = "Unsupported image version.";
+      return false;
+    }
+
+    compression = ImageCompression(uint8_t(data[5]));
+    bandHeight  = readValue<uint16_t>(data+6);
+    width       = readValue<uint32_t>(data+8);
+    height      = readValue<uint32_t>(data+12);
+    bandCount   = readValue<uint32_t>(data+16);
+
+    if(compression!=ImageCompression::None && compression!=ImageCompression::RowPrediction)
+    {
+      error = "Unsupported image compression.";
+      return false;
+    }
+
+    if(bandHeight==0 || bandCount != (height+bandHeight-1)/bandHeight)
+    {
+      error = "Invalid image band count.";
+      return false;
+    }
+
+    size_t tableSize = (bandCount+1)*8;
+    if(size < fixedHeaderSize+tableSize)
+    {
+      error = "Image offset table truncated.";
+      return false;
+    }
+
+    offsets = data+fixedHeaderSize;
+    bands = offsets+tableSize;
+    bandsSize = size-fixedHeaderSize-tableSize;
+
+    // Check the size against the payload before the pixels are allocated so that a small corrupt
+    // header can't request a huge allocation.
+    size_t pixelCount = width*height;
+    size_t maxBytes = (compression==ImageCompression::None)?bandsSize:bandsSize*maxRunLengthExpansion;
+    if(pixelCount>std::numeric_limits<size_t>::max()/4 || pixelCount*4>maxBytes)
+    {
+      error = "Image size does not match its data.";
+      return false;
+    }
+
+    return true;
+  }
+
+  //################################################################################################
+  //! Decode a band into rows*width pixels.
+  bool decodeBand(std::string& error, size_t band, TPPixel* output) const
+  {
+    auto begin = readValue<uint64_t>(offsets+band*8);
+    auto end   = readValue<uint64_t>(offsets+band*8+8);
+    if(begin>end || end>bandsSize)
+    {
+      error = "Invalid image band offset.";
+      return false;
+    }
+
+    size_t rows = std::min(bandHeight, height-band*bandHeight);
+    size_t rowBytes = width*4;
+    size_t bytes = rowBytes*rows;
+    auto out = reinterpret_cast<uint8_t*>(output);
+    auto in = reinterpret_cast<const uint8_t*>(bands+begin);
+    size_t inSize = size_t(end-begin);
+
+    if(compression==ImageCompression::None)
+    {
+      if(inSize!=bytes)
+      {
+        error = "Invalid raw image band size.";
+        return false;
+      }
+      memcpy(out, in, bytes);
+      return true;
+    }
+
+    if(!runLengthDecode(in, inSize, out, bytes))
+    {
+      error = "Failed to decode image band.";
+      return false;
+    }
+
+    unpredictBand(out, rowBytes, rows);
+    return true;
+  }
+};
+}
+
+//##################################################################################################
+ImageMember::ImageMember(const tp_utils::StringID& name):
+  AbstractMember(name, imageSID())
+{
+
+}
+
+//##################################################################################################
+ImageMember::~ImageMember() = default;
+
+//##################################################################################################
+void ImageMember::setSize(size_t width, size_t height)
+{
+  m_width = width;
+  m_height = height;
+  data.assign(width*height, TPPixel());
+}
+
+//##################################################################################################
+size_t ImageMember::width() const
+{
+  return m_width;
+}
+
+//##################################################################################################
+size_t ImageMember::height() const
+{
+  return m_height;
+}
+
+//##################################################################################################
+TPPixel& ImageMember::pixel(size_t x, size_t y)
+{
+  return data[y*m_width + x];
+}
+
+//##################################################################################################
+const TPPixel& ImageMember::pixel(size_t x, size_t y) const
+{
+  return data[y*m_width + x];
+}
+
+//##################################################################################################
+ImageMember* ImageMember::fromData(std::string& error, std::string_view data)
+{
+  Header header;
+  if(!header.parse(error, data.data(), data.size()))
+    return nullptr;
+
+  auto member = new ImageMember();
+  member->m_width = header.width;
+  member->m_height = header.height;
+  member->data.resize(header.width*header.height);
+
+  for(size_t band=0; band<header.bandCount; band++)
+  {
+    if(!header.decodeBand(error, band, member->data.data() + band*header.bandHeight*header.width))
+    {
+      delete member;
+      return nullptr;
+    }
+  }
+
+  return member;
+}
+
+//##################################################################################################
+std::string ImageMember::toData(ImageCompression compression) const
+{
+  std::string output;
+  appendData(output, compression);
+  return output;
+}
+
+//##################################################################################################
+void ImageMember::appendData(std::string& output, ImageCompression compression) const
+{
+  size_t bandHeight = defaultBandHeight;
+  size_t bandCount = (m_height+bandHeight-1)/bandHeight;
+  size_t rowBytes = m_width*4;
+
+  output.reserve(output.size() + fixedHeaderSize + (bandCount+1)*8 + rowBytes*m_height);
+  output.append("TPIM", 4);
+  output.push_back(char(formatVersion));
+  output.push_back(char(compression));
+  appendValue(output, uint16_t(bandHeight));
+  appendValue(output, uint32_t(m_width));
+  appendValue(output, uint32_t(m_height));
+  appendValue(output, uint32_t(bandCount));
+  appendValue(output, uint32_t(0));
+
+  size_t tableOffset = output.size();
+  output.resize(tableOffset + (bandCount+1)*8, '\0');
+  size_t bandsOffset = output.size();
+
+  std::vector<uint8_t> residuals;
+  for(size_t band=0; band<bandCount; band++)
+  {
+    uint64_t offset = output.size()-bandsOffset;
+    memcpy(&output[tableOffset+band*8], &offset, 8);
+    if(!hostIsLittleEndian())
+      byteSwapInPlace(reinterpret_cast<uint64_t*>(&output[tableOffset+band*8]), 1);
+
+    size_t rows = std::min(bandHeight, m_height-band*bandHeight);
+    auto pixels = reinterpret_cast<const uint8_t*>(data.data() + band*bandHeight*m_width);
+
+    if(compression==ImageCompression::None)
+      output.append(reinterpret_cast<const char*>(pixels), rowBytes*rows);
+    else
+    {
+      predictBand(pixels, rowBytes, rows, residuals);
+      runLengthEncode(residuals.data(), residuals.size(), output);
+    }
+  }
+
+  uint64_t end = output.size()-bandsOffset;
+  memcpy(&output[tableOffset+bandCount*8], &end, 8);
+  if(!hostIsLittleEndian())
+    byteSwapInPlace(reinterpret_cast<uint64_t*>(&output[tableOffset+bandCount*8]), 1);
+}
+
+//##################################################################################################
+void ImageMember::copyData(const ImageMember& other)
+{
+  m_width = other.m_width;
+  m_height = other.m_height;
+  data = other.data;
+}
+
+//##################################################################################################
+size_t ImageMember::memoryUsage() const
+{
+  return sizeof(ImageMember) + heapMemoryUsage(data);
+}
+
+//##################################################################################################
+bool ImageMember::readRegion(std::string& error,
+                             const char* data,
+                             size_t size,
+                             size_t x,
+                             size_t y,
+                             size_t width,
+                             size_t height,
+                             std::vector<TPPixel>& pixels)
+{
+  Header header;
+  if(!header.parse(error, data, size))
+    return false;
+
+  if(x+width>header.width || y+height>header.height)
+  {
+    error = "Image region out of bounds.";
+    return false;
+  }
+
+  pixels.resize(width*height);
+  if(width==0 || height==0)
+    return true;
+
+  std::vector<TPPixel> bandPixels(header.bandHeight*header.width);
+  size_t firstBand = y/header.bandHeight;
+  size_t lastBand = (y+height-1)/header.bandHeight;
+  for(size_t band=firstBand; band<=lastBand; band++)
+  {
+    if(!header.decodeBand(error, band, bandPixels.data()))
+      return false;
+
+    size_t bandY = band*header.bandHeight;
+    size_t rowBegin = std::max(y, bandY);
+    size_t rowEnd = std::min(y+height, bandY+header.bandHeight);
+    for(size_t row=rowBegin; row<rowEnd; row++)
+    {
+      const TPPixel* src = bandPixels.data() + (row-bandY)*header.width + x;
+      std::copy(src, src+width, pixels.data() + (row-y)*width);
+    }
+  }
+
+  return true;
+}
+
+//##################################################################################################
+ImageMemberFactory::ImageMemberFactory(TPPixel color, ImageCompression compression):
+  AbstractMemberFactory(imageSID(), ImageMember::extension, color),
+  m_compression(compression)
+{
+
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> ImageMemberFactory::clone(std::string& error, const AbstractMember& member) const
+{
+  auto m = dynamic_cast<const ImageMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return nullptr;
+  }
+
+  auto newMember = new ImageMember();
+  newMember->copyData(*m);
+  return std::shared_ptr<AbstractMember>(newMember);
+}
+
+//##################################################################################################
+void ImageMemberFactory::save(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  data.clear();
+  saveAppend(error, member, data);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> ImageMemberFactory::load(std::string& error, const std::string& data) const
+{
+  return loadView(error, data);
+}
+
+//##################################################################################################
+void ImageMemberFactory::saveAppend(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  auto m = dynamic_cast<const ImageMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return;
+  }
+
+  if(m->data.size() != m->width()*m->height())
+  {
+    error = "Image data does not match its size.";
+    return;
+  }
+
+  m->appendData(data, m_compression);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> ImageMemberFactory::loadView(std::string& error, std::string_view data) const
+{
+  return std::shared_ptr<AbstractMember>(ImageMember::fromData(error, data));
+}
+
+}
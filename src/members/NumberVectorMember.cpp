@@ -0,0 +1,6 @@
+#include "tp_data/members/NumberVectorMember.h"
+
+namespace tp_data
+{
+const std::string NumberVectorMemberExtension::extension{"bin"};
+}
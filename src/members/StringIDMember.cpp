@@ -15,18 +15,26 @@ StringIDMember::StringIDMember(const tp_utils::StringID& name, const tp_utils::S
 StringIDMember::~StringIDMember() = default;
 
 //##################################################################################################
-StringIDMember* StringIDMember::fromData(std::string& error, const std::string& data)
+StringIDMember* StringIDMember::fromData(std::string& error, std::string_view data)
 {
   TP_UNUSED(error);
   auto member = new StringIDMember();
-  member->data = data;
+  member->data = std::string(data);
   return member;
 }
 
 //##################################################################################################
 std::string StringIDMember::toData() const
 {
-  return data.toString();
+  std::string output;
+  appendData(output);
+  return output;
+}
+
+//##################################################################################################
+void StringIDMember::appendData(std::string& output) const
+{
+  output += data.toString();
 }
 
 //##################################################################################################
@@ -35,5 +43,11 @@ void StringIDMember::copyData(const StringIDMember& other)
   data = other.data;
 }
 
+//##################################################################################################
+size_t StringIDMember::memoryUsage() const
+{
+  return sizeof(StringIDMember);
+}
+
 }
 
@@ -1,14 +1,105 @@
 #include "tp_data/members/StringIDVectorMember.h"
+#include "tp_data/BinaryUtils.h"
+#include "tp_data/MemoryUsage.h"
 
 #include "tp_utils/JSONUtils.h"
 
+#include <unordered_map>
+
 namespace tp_data
 {
 const std::string StringIDVectorMember::extension{"json"};
+const std::string StringIDVectorMember::binaryExtension{"siv"};
+
+namespace
+{
+//JSON text can't start with a null so this is used to identify the binary encoding.
+const std::string binaryMagic{"\0SIV", 4};
+
+//##################################################################################################
+bool fromBinary(std::string& error, std::string_view data, std::vector<tp_utils::StringID>& output)
+{
+  const char* p = data.data() + binaryMagic.size();
+  const char* end = data.data() + data.size();
+
+  auto fail = [&]
+  {
+    error = "Invalid binary string id vector.";
+    output.clear();
+    return false;
+  };
+
+  uint64_t count=0;
+  uint64_t tableSize=0;
+  if(!readVarint(p, end, count) || !readVarint(p, end, tableSize) || tableSize>uint64_t(end-p))
+    return fail();
+
+  std::vector<tp_utils::StringID> table;
+  table.reserve(size_t(tableSize));
+  for(uint64_t i=0; i<tableSize; i++)
+  {
+    uint64_t len=0;
+    if(!readVarint(p, end, len) || len>uint64_t(end-p))
+      return fail();
+
+    table.emplace_back(std::string(p, size_t(len)));
+    p += len;
+  }
+
+  if(count>uint64_t(end-p))
+    return fail();
+
+  output.reserve(size_t(count));
+  for(uint64_t i=0; i<count; i++)
+  {
+    uint64_t index=0;
+    if(!readVarint(p, end, index) || index>=table.size())
+      return fail();
+
+    output.push_back(table[size_t(index)]);
+  }
+
+  return true;
+}
+
+//##################################################################################################
+void appendBinary(const std::vector<tp_utils::StringID>& data, std::string& output)
+{
+  std::vector<const std::string*> table;
+  std::vector<uint64_t> indices;
+  indices.reserve(data.size());
+
+  {
+    std::unordered_map<tp_utils::StringID, uint64_t> lookup;
+    for(const auto& s : data)
+    {
+      auto i = lookup.find(s);
+      if(i == lookup.end())
+      {
+        i = lookup.emplace(s, table.size()).first;
+        table.push_back(&s.keyString());
+      }
+      indices.push_back(i->second);
+    }
+  }
+
+  output += binaryMagic;
+  appendVarint(output, data.size());
+  appendVarint(output, table.size());
+  for(const auto s : table)
+  {
+    appendVarint(output, s->size());
+    output.append(*s);
+  }
+
+  for(auto index : indices)
+    appendVarint(output, index);
+}
+}
 
 //##################################################################################################
 StringIDVectorMember::StringIDVectorMember(const tp_utils::StringID& name, const std::vector<tp_utils::StringID>& data_):
-  AbstractMember(name, stringSID())
+  AbstractMember(name, stringIDVectorSID())
 {
   data = data_;
 }
@@ -17,20 +108,44 @@ StringIDVectorMember::StringIDVectorMember(const tp_utils::StringID& name, const
 StringIDVectorMember::~StringIDVectorMember() = default;
 
 //##################################################################################################
-StringIDVectorMember* StringIDVectorMember::fromData(std::string& error, const std::string& data)
+StringIDVectorMember* StringIDVectorMember::fromData(std::string& error, std::string_view data)
 {
-  TP_UNUSED(error);
   auto member = new StringIDVectorMember();
-  tp_utils::loadVectorOfStringIDsFromJSON(tp_utils::jsonFromString(data), member->data);
+
+  if(data.substr(0, binaryMagic.size()) == binaryMagic)
+  {
+    if(!fromBinary(error, data, member->data))
+    {
+      delete member;
+      return nullptr;
+    }
+  }
+  else
+    tp_utils::loadVectorOfStringIDsFromJSON(tp_utils::jsonFromString(std::string(data)), member->data);
+
   return member;
 }
 
 //##################################################################################################
-std::string StringIDVectorMember::toData() const
+std::string StringIDVectorMember::toData(StringIDVectorEncoding encoding) const
 {
+  std::string output;
+  appendData(output, encoding);
+  return output;
+}
+
+//##################################################################################################
+void StringIDVectorMember::appendData(std::string& output, StringIDVectorEncoding encoding) const
+{
+  if(encoding == StringIDVectorEncoding::Binary)
+  {
+    appendBinary(data, output);
+    return;
+  }
+
   nlohmann::json j;
   tp_utils::saveVectorOfStringIDsToJSON(j, data);
-  return j.dump(2);
+  output += j.dump(2);
 }
 
 //##################################################################################################
@@ -39,5 +154,67 @@ void StringIDVectorMember::copyData(const StringIDVectorMember& other)
   data = other.data;
 }
 
+//##################################################################################################
+size_t StringIDVectorMember::memoryUsage() const
+{
+  return sizeof(StringIDVectorMember) + heapMemoryUsage(data);
+}
+
+//##################################################################################################
+StringIDVectorMemberFactory::StringIDVectorMemberFactory(TPPixel color, StringIDVectorEncoding encoding):
+  AbstractMemberFactory(stringIDVectorSID(),
+                        (encoding==StringIDVectorEncoding::Binary)?StringIDVectorMember::binaryExtension:StringIDVectorMember::extension,
+                        color),
+  m_encoding(encoding)
+{
+
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> StringIDVectorMemberFactory::clone(std::string& error, const AbstractMember& member) const
+{
+  auto m = dynamic_cast<const StringIDVectorMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return nullptr;
+  }
+
+  auto newMember = new StringIDVectorMember();
+  newMember->data = m->data;
+  return std::shared_ptr<AbstractMember>(newMember);
+}
+
+//##################################################################################################
+void StringIDVectorMemberFactory::save(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  data.clear();
+  saveAppend(error, member, data);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> StringIDVectorMemberFactory::load(std::string& error, const std::string& data) const
+{
+  return loadView(error, data);
 }
 
+//##################################################################################################
+void StringIDVectorMemberFactory::saveAppend(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  auto m = dynamic_cast<const StringIDVectorMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return;
+  }
+
+  m->appendData(data, m_encoding);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> StringIDVectorMemberFactory::loadView(std::string& error, std::string_view data) const
+{
+  return std::shared_ptr<AbstractMember>(StringIDVectorMember::fromData(error, data));
+}
+
+}
@@ -1,4 +1,5 @@
 #include "tp_data/members/StringMember.h"
+#include "tp_data/MemoryUsage.h"
 
 namespace tp_data
 {
@@ -15,7 +16,7 @@ StringMember::StringMember(const tp_utils::StringID& name, const std::string& da
 StringMember::~StringMember() = default;
 
 //##################################################################################################
-StringMember* StringMember::fromData(std::string& error, const std::string& data)
+StringMember* StringMember::fromData(std::string& error, std::string_view data)
 {
   TP_UNUSED(error);
   auto member = new StringMember();
@@ -26,7 +27,15 @@ StringMember* StringMember::fromData(std::string& error, const std::string& data
 //##################################################################################################
 std::string StringMember::toData() const
 {
-  return data;
+  std::string output;
+  appendData(output);
+  return output;
+}
+
+//##################################################################################################
+void StringMember::appendData(std::string& output) const
+{
+  output += data;
 }
 
 //##################################################################################################
@@ -35,5 +44,11 @@ void StringMember::copyData(const StringMember& other)
   data = other.data;
 }
 
+//##################################################################################################
+size_t StringMember::memoryUsage() const
+{
+  return sizeof(StringMember) + heapMemoryUsage(data);
+}
+
 }
 
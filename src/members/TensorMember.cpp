@@ -0,0 +1,499 @@
+#include "tp_data/members/TensorMember.h"
+#include "tp_data/BinaryUtils.h"
+#include "tp_data/MemoryUsage.h"
+
+#include "tp_utils/DebugUtils.h"
+
+#include <limits>
+
+namespace tp_data
+{
+const std::string TensorMember::extension{"tensor"};
+
+namespace
+{
+//The header is padded to a multiple of this so that the values are aligned in the file.
+constexpr size_t headerAlignment=64;
+constexpr uint8_t formatVersion=1;
+constexpr size_t fixedHeaderSize=24;
+
+//##################################################################################################
+template<typename T>
+void appendValue(std::string& output, T value)
+{
+  appendLittleEndian(output, &value, 1);
+}
+
+//##################################################################################################
+template<typename T>
+T readValue(const char* input)
+{
+  T value;
+  readLittleEndian(input, &value, 1);
+  return value;
+}
+
+//##################################################################################################
+//! Multiply without overflow, returns false if the result does not fit.
+bool checkedMultiply(uint64_t a, uint64_t b, uint64_t& result)
+{
+  if(a!=0 && b>std::numeric_limits<uint64_t>::max()/a)
+    return false;
+  result = a*b;
+  return true;
+}
+
+//##################################################################################################
+//! Add without overflow, returns false if the result does not fit.
+bool checkedAdd(uint64_t a, uint64_t b, uint64_t& result)
+{
+  if(b>std::numeric_limits<uint64_t>::max()-a)
+    return false;
+  result = a+b;
+  return true;
+}
+
+//##################################################################################################
+//! The number of elements in a shape, or false if a dimension is negative or the count overflows.
+bool checkedElementCount(const std::vector<int64_t>& shape, uint64_t& count)
+{
+  count=1;
+  for(auto s : shape)
+    if(s<0 || !checkedMultiply(count, uint64_t(s), count))
+      return false;
+  return count<=std::numeric_limits<size_t>::max();
+}
+
+//##################################################################################################
+std::vector<int64_t> contiguousStrides(const std::vector<int64_t>& shape)
+{
+  std::vector<int64_t> strides(shape.size());
+  int64_t stride=1;
+  for(size_t i=shape.size(); i>0; i--)
+  {
+    strides[i-1] = stride;
+    stride *= shape[i-1];
+  }
+  return strides;
+}
+
+//##################################################################################################
+//! The number of bytes spanned by the shape and strides, or false if they are invalid.
+bool spanBytes(std::string& error,
+               TensorDType dtype,
+               const std::vector<int64_t>& shape,
+               const std::vector<int64_t>& strides,
+               size_t& bytes)
+{
+  size_t dtypeSize = tensorDTypeSize(dtype);
+  if(dtypeSize==0)
+  {
+    error = "Invalid tensor dtype.";
+    return false;
+  }
+
+  if(shape.size() != strides.size())
+  {
+    error = "Tensor shape and strides have different sizes.";
+    return false;
+  }
+
+  uint64_t span=1;
+  for(size_t i=0; i<shape.size(); i++)
+  {
+    if(shape[i]<0 || strides[i]<0)
+    {
+      error = "Tensor shape and strides must not be negative.";
+      return false;
+    }
+
+    if(shape[i]==0)
+    {
+      bytes = 0;
+      return true;
+    }
+
+    uint64_t extent=0;
+    if(!checkedMultiply(uint64_t(shape[i]-1), uint64_t(strides[i]), extent) || !checkedAdd(span, extent, span))
+    {
+      error = "Tensor shape and strides are too large.";
+      return false;
+    }
+  }
+
+  uint64_t total=0;
+  if(!checkedMultiply(span, dtypeSize, total) || total>std::numeric_limits<size_t>::max())
+  {
+    error = "Tensor shape and strides are too large.";
+    return false;
+  }
+
+  bytes = size_t(total);
+  return true;
+}
+
+//##################################################################################################
+void byteSwapValues(TensorDType dtype, char* data, size_t bytes)
+{
+  switch(tensorDTypeSize(dtype))
+  {
+  case 2: byteSwapInPlace(reinterpret_cast<uint16_t*>(data), bytes/2); break;
+  case 4: byteSwapInPlace(reinterpret_cast<uint32_t*>(data), bytes/4); break;
+  case 8: byteSwapInPlace(reinterpret_cast<uint64_t*>(data), bytes/8); break;
+  default: break;
+  }
+}
+}
+
+//##################################################################################################
+size_t tensorDTypeSize(TensorDType dtype)
+{
+  switch(dtype)
+  {
+  case TensorDType::Float32: return 4;
+  case TensorDType::Float64: return 8;
+  case TensorDType::Int8:    return 1;
+  case TensorDType::UInt8:   return 1;
+  case TensorDType::Int16:   return 2;
+  case TensorDType::UInt16:  return 2;
+  case TensorDType::Int32:   return 4;
+  case TensorDType::UInt32:  return 4;
+  case TensorDType::Int64:   return 8;
+  case TensorDType::UInt64:  return 8;
+  }
+  return 0;
+}
+
+//##################################################################################################
+std::string tensorDTypeToString(TensorDType dtype)
+{
+  switch(dtype)
+  {
+  case TensorDType::Float32: return "Float32";
+  case TensorDType::Float64: return "Float64";
+  case TensorDType::Int8:    return "Int8";
+  case TensorDType::UInt8:   return "UInt8";
+  case TensorDType::Int16:   return "Int16";
+  case TensorDType::UInt16:  return "UInt16";
+  case TensorDType::Int32:   return "Int32";
+  case TensorDType::UInt32:  return "UInt32";
+  case TensorDType::Int64:   return "Int64";
+  case TensorDType::UInt64:  return "UInt64";
+  }
+  return "Invalid";
+}
+
+//##################################################################################################
+TensorMember::TensorMember(const tp_utils::StringID& name):
+  AbstractMember(name, tensorSID())
+{
+
+}
+
+//##################################################################################################
+TensorMember::~TensorMember() = default;
+
+//##################################################################################################
+void TensorMember::allocate(TensorDType dtype, const std::vector<int64_t>& shape)
+{
+  uint64_t count=0;
+  uint64_t bytes=0;
+  if(!checkedElementCount(shape, count) || !checkedMultiply(count, tensorDTypeSize(dtype), bytes) || bytes>std::numeric_limits<size_t>::max())
+  {
+    tpWarning() << "TensorMember::allocate invalid shape, allocating an empty tensor.";
+    m_dtype = dtype;
+    m_shape = {0};
+    m_strides = {1};
+    m_buffer = SharedBuffer();
+    return;
+  }
+
+  m_dtype = dtype;
+  m_shape = shape;
+  m_strides = contiguousStrides(shape);
+  m_buffer = SharedBuffer::allocate(size_t(bytes));
+}
+
+//##################################################################################################
+void TensorMember::setBuffer(std::string& error,
+                             TensorDType dtype,
+                             const std::vector<int64_t>& shape,
+                             const std::vector<int64_t>& strides,
+                             const SharedBuffer& buffer)
+{
+  auto s = strides.empty()?contiguousStrides(shape):strides;
+
+  size_t bytes=0;
+  if(!spanBytes(error, dtype, shape, s, bytes))
+    return;
+
+  if(buffer.size()<bytes)
+  {
+    error = "Tensor buffer is too small for its shape.";
+    return;
+  }
+
+  //Broadcast dimensions have a stride of 0 so the element count is not limited by the span.
+  uint64_t count=0;
+  if(!checkedElementCount(shape, count))
+  {
+    error = "Tensor shape is too large.";
+    return;
+  }
+
+  m_dtype = dtype;
+  m_shape = shape;
+  m_strides = std::move(s);
+  m_buffer = buffer;
+}
+
+//##################################################################################################
+TensorDType TensorMember::dtype() const
+{
+  return m_dtype;
+}
+
+//##################################################################################################
+const std::vector<int64_t>& TensorMember::shape() const
+{
+  return m_shape;
+}
+
+//##################################################################################################
+const std::vector<int64_t>& TensorMember::strides() const
+{
+  return m_strides;
+}
+
+//##################################################################################################
+size_t TensorMember::elementCount() const
+{
+  //The shape is validated when it is set so this does not overflow.
+  size_t count=1;
+  for(auto s : m_shape)
+    count *= size_t(s);
+  return count;
+}
+
+//##################################################################################################
+bool TensorMember::isContiguous() const
+{
+  return m_strides == contiguousStrides(m_shape);
+}
+
+//##################################################################################################
+const SharedBuffer& TensorMember::buffer() const
+{
+  return m_buffer;
+}
+
+//##################################################################################################
+const void* TensorMember::data() const
+{
+  return m_buffer.data();
+}
+
+//##################################################################################################
+void* TensorMember::mutableData()
+{
+  if(auto d = m_buffer.mutableData(); d)
+    return d;
+
+  m_buffer = SharedBuffer::copy(m_buffer.data(), m_buffer.size());
+  return m_buffer.mutableData();
+}
+
+//##################################################################################################
+TensorMember* TensorMember::fromData(std::string& error, std::string_view data)
+{
+  return fromSharedData(error, SharedBuffer::copy(data.data(), data.size()));
+}
+
+//##################################################################################################
+TensorMember* TensorMember::fromSharedData(std::string& error, const SharedBuffer& data)
+{
+  const char* d = data.data();
+
+  if(data.size()<fixedHeaderSize || memcmp(d, "TPTN", 4)!=0)
+  {
+    error = "Invalid tensor header.";
+    return nullptr;
+  }
+
+  if(uint8_t(d[4]) != formatVersion)
+  {
+    error = "Unsupported tensor version.";
+    return nullptr;
+  }
+
+  auto dtype       = TensorDType(uint8_t(d[5]));
+  auto ndim        = readValue<uint16_t>(d+6);
+  auto headerSize  = readValue<uint32_t>(d+8);
+  auto payloadSize = readValue<uint64_t>(d+16);
+
+  if(headerSize < fixedHeaderSize + size_t(ndim)*16 || headerSize>data.size() || payloadSize>data.size()-headerSize)
+  {
+    error = "Invalid tensor header size.";
+    return nullptr;
+  }
+
+  std::vector<int64_t> shape(ndim);
+  std::vector<int64_t> strides(ndim);
+  readLittleEndian(d+fixedHeaderSize, shape.data(), ndim);
+  readLittleEndian(d+fixedHeaderSize+size_t(ndim)*8, strides.data(), ndim);
+
+  auto payload = data.slice(headerSize, size_t(payloadSize));
+
+  //Values can be used in place if they are little endian and aligned, else they need to be copied.
+  size_t dtypeSize = tensorDTypeSize(dtype);
+  bool aligned = dtypeSize && (reinterpret_cast<uintptr_t>(payload.data()) % dtypeSize)==0;
+  if(!hostIsLittleEndian() || !aligned)
+  {
+    payload = SharedBuffer::copy(payload.data(), payload.size());
+    if(!hostIsLittleEndian())
+      byteSwapValues(dtype, payload.mutableData(), payload.size());
+  }
+
+  auto member = new TensorMember();
+  member->setBuffer(error, dtype, shape, strides, payload);
+  if(!error.empty())
+  {
+    delete member;
+    return nullptr;
+  }
+
+  return member;
+}
+
+//##################################################################################################
+std::string TensorMember::toData(std::string& error) const
+{
+  std::string output;
+  appendData(error, output);
+  return output;
+}
+
+//##################################################################################################
+void TensorMember::appendData(std::string& error, std::string& output) const
+{
+  size_t payloadSize=0;
+  if(!spanBytes(error, m_dtype, m_shape, m_strides, payloadSize))
+    return;
+
+  if(m_buffer.size()<payloadSize)
+  {
+    error = "Tensor buffer is too small for its shape and strides.";
+    return;
+  }
+
+  size_t ndim = m_shape.size();
+  size_t headerSize = ((fixedHeaderSize + ndim*16 + headerAlignment-1) / headerAlignment) * headerAlignment;
+
+  size_t start = output.size();
+  output.reserve(start + headerSize + payloadSize);
+  output.append("TPTN", 4);
+  output.push_back(char(formatVersion));
+  output.push_back(char(m_dtype));
+  appendValue(output, uint16_t(ndim));
+  appendValue(output, uint32_t(headerSize));
+  appendValue(output, uint32_t(0));
+  appendValue(output, uint64_t(payloadSize));
+  appendLittleEndian(output, m_shape.data(), ndim);
+  appendLittleEndian(output, m_strides.data(), ndim);
+  output.resize(start + headerSize, '\0');
+
+  size_t offset = output.size();
+  output.append(m_buffer.data(), payloadSize);
+  if(!hostIsLittleEndian())
+    byteSwapValues(m_dtype, &output[offset], payloadSize);
+}
+
+//##################################################################################################
+void TensorMember::copyData(const TensorMember& other)
+{
+  m_dtype = other.m_dtype;
+  m_shape = other.m_shape;
+  m_strides = other.m_strides;
+  m_buffer = other.m_buffer;
+}
+
+//##################################################################################################
+size_t TensorMember::memoryUsage() const
+{
+  return sizeof(TensorMember) + heapMemoryUsage(m_shape) + heapMemoryUsage(m_strides) + m_buffer.size();
+}
+
+//##################################################################################################
+TensorMemberFactory::TensorMemberFactory(TPPixel color):
+  AbstractMemberFactory(tensorSID(), TensorMember::extension, color)
+{
+
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> TensorMemberFactory::clone(std::string& error, const AbstractMember& member) const
+{
+  auto m = dynamic_cast<const TensorMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return nullptr;
+  }
+
+  //The buffer is shared, it will be copied if either member is modified.
+  auto newMember = new TensorMember();
+  newMember->copyData(*m);
+  return std::shared_ptr<AbstractMember>(newMember);
+}
+
+//##################################################################################################
+void TensorMemberFactory::save(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  data.clear();
+  saveAppend(error, member, data);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> TensorMemberFactory::load(std::string& error, const std::string& data) const
+{
+  return loadView(error, data);
+}
+
+//##################################################################################################
+void TensorMemberFactory::saveAppend(std::string& error, const AbstractMember& member, std::string& data) const
+{
+  auto m = dynamic_cast<const TensorMember*>(&member);
+  if(!m)
+  {
+    error = "Failed to find member of type " + type().toString();
+    return;
+  }
+
+  m->appendData(error, data);
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> TensorMemberFactory::loadView(std::string& error, std::string_view data) const
+{
+  return std::shared_ptr<AbstractMember>(TensorMember::fromData(error, data));
+}
+
+//##################################################################################################
+std::shared_ptr<AbstractMember> TensorMemberFactory::loadShared(std::string& error, const SharedBuffer& data) const
+{
+  return std::shared_ptr<AbstractMember>(TensorMember::fromSharedData(error, data));
+}
+
+//##################################################################################################
+bool TensorMemberFactory::sharesLoadedData() const
+{
+  return true;
+}
+
+//##################################################################################################
+size_t TensorMemberFactory::dataAlignment() const
+{
+  return 64;
+}
+
+}
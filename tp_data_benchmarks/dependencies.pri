@@ -0,0 +1 @@
+DEPENDENCIES += tp_data
@@ -0,0 +1,246 @@
+#include "Harness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+
+#ifdef _WIN32
+#  include <malloc.h>
+#endif
+
+namespace
+{
+std::atomic<size_t> allocations{0}; // NOLINT
+
+//##################################################################################################
+void* allocate(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if(void* p = std::malloc(size?size:1); p)
+    return p;
+  throw std::bad_alloc();
+}
+
+//##################################################################################################
+void* allocateAligned(size_t size, std::align_val_t alignment)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  auto a = size_t(alignment);
+  size = ((size?size:1) + a - 1) / a * a;
+#ifdef _WIN32
+  void* p = _aligned_malloc(size, a);
+#else
+  void* p = std::aligned_alloc(a, size);
+#endif
+  if(p)
+    return p;
+  throw std::bad_alloc();
+}
+
+//##################################################################################################
+void freeAligned(void* p)
+{
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+}
+
+//-- Replace the global allocation functions to count allocations ----------------------------------
+void* operator new(size_t size){return allocate(size);}
+void* operator new[](size_t size){return allocate(size);}
+void* operator new(size_t size, std::align_val_t alignment){return allocateAligned(size, alignment);}
+void* operator new[](size_t size, std::align_val_t alignment){return allocateAligned(size, alignment);}
+void operator delete(void* p) noexcept{std::free(p);}
+void operator delete[](void* p) noexcept{std::free(p);}
+void operator delete(void* p, size_t) noexcept{std::free(p);}
+void operator delete[](void* p, size_t) noexcept{std::free(p);}
+void operator delete(void* p, std::align_val_t) noexcept{freeAligned(p);}
+void operator delete[](void* p, std::align_val_t) noexcept{freeAligned(p);}
+void operator delete(void* p, size_t, std::align_val_t) noexcept{freeAligned(p);}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept{freeAligned(p);}
+
+namespace tp_data_benchmarks
+{
+
+//##################################################################################################
+size_t allocationCount()
+{
+  return allocations.load(std::memory_order_relaxed);
+}
+
+//##################################################################################################
+double Result::opsPerSecond() const
+{
+  return (meanNS>0.0)?(1.0e9/meanNS):0.0;
+}
+
+//##################################################################################################
+double Result::itemsPerSecond() const
+{
+  return opsPerSecond() * double(itemsPerOp);
+}
+
+//##################################################################################################
+double Result::megabytesPerSecond() const
+{
+  return opsPerSecond() * double(bytesPerOp) / (1024.0*1024.0);
+}
+
+//##################################################################################################
+nlohmann::json Result::toJSON() const
+{
+  nlohmann::json j;
+  j["name"]               = name;
+  j["iterations"]         = iterations;
+  j["items_per_op"]       = itemsPerOp;
+  j["bytes_per_op"]       = bytesPerOp;
+  j["min_ns"]             = minNS;
+  j["mean_ns"]            = meanNS;
+  j["p50_ns"]             = p50NS;
+  j["p90_ns"]             = p90NS;
+  j["p99_ns"]             = p99NS;
+  j["ops_per_second"]     = opsPerSecond();
+  j["items_per_second"]   = itemsPerSecond();
+  j["mb_per_second"]      = megabytesPerSecond();
+  j["allocations_per_op"] = allocationsPerOp;
+  return j;
+}
+
+//##################################################################################################
+Harness::Harness(size_t minIterations, double minSeconds, const std::string& filter):
+  m_minIterations(std::max(minIterations, size_t(1))),
+  m_minSeconds(minSeconds),
+  m_filter(filter)
+{
+
+}
+
+//##################################################################################################
+void Harness::run(const std::string& name,
+                  size_t itemsPerOp,
+                  size_t bytesPerOp,
+                  const std::function<void()>& operation,
+                  const std::function<void()>& setup)
+{
+  if(!m_filter.empty() && name.find(m_filter) == std::string::npos)
+    return;
+
+  //Warm up caches and any lazily built state.
+  if(setup)
+    setup();
+  operation();
+
+  std::vector<double> times;
+  times.reserve(m_minIterations);
+  size_t allocationTotal=0;
+  double totalNS=0.0;
+
+  while(times.size()<m_minIterations || totalNS<m_minSeconds*1.0e9)
+  {
+    if(setup)
+      setup();
+
+    size_t allocationsBefore = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    auto end = std::chrono::steady_clock::now();
+    allocationTotal += allocationCount() - allocationsBefore;
+
+    double ns = std::chrono::duration<double, std::nano>(end-start).count();
+    times.push_back(ns);
+    totalNS += ns;
+  }
+
+  std::sort(times.begin(), times.end());
+  auto percentile = [&](double p)
+  {
+    auto i = size_t(p * double(times.size()-1) + 0.5);
+    return times.at(std::min(i, times.size()-1));
+  };
+
+  Result& result = m_results.emplace_back();
+  result.name = name;
+  result.iterations = times.size();
+  result.itemsPerOp = itemsPerOp;
+  result.bytesPerOp = bytesPerOp;
+  result.minNS = times.front();
+  result.meanNS = totalNS / double(times.size());
+  result.p50NS = percentile(0.50);
+  result.p90NS = percentile(0.90);
+  result.p99NS = percentile(0.99);
+  result.allocationsPerOp = double(allocationTotal) / double(times.size());
+}
+
+//##################################################################################################
+const std::vector<Result>& Harness::results() const
+{
+  return m_results;
+}
+
+//##################################################################################################
+void Harness::printTable(std::ostream& stream) const
+{
+  stream << std::left << std::setw(48) << "benchmark"
+         << std::right
+         << std::setw(12) << "p50 us"
+         << std::setw(12) << "p90 us"
+         << std::setw(12) << "p99 us"
+         << std::setw(14) << "items/s"
+         << std::setw(10) << "MB/s"
+         << std::setw(12) << "allocs/op"
+         << '\n';
+
+  stream << std::fixed;
+  for(const auto& r : m_results)
+  {
+    stream << std::left << std::setw(48) << r.name
+           << std::right << std::setprecision(2)
+           << std::setw(12) << r.p50NS/1000.0
+           << std::setw(12) << r.p90NS/1000.0
+           << std::setw(12) << r.p99NS/1000.0
+           << std::setprecision(0)
+           << std::setw(14) << r.itemsPerSecond()
+           << std::setprecision(1)
+           << std::setw(10) << r.megabytesPerSecond()
+           << std::setw(12) << r.allocationsPerOp
+           << '\n';
+  }
+}
+
+//##################################################################################################
+nlohmann::json Harness::toJSON() const
+{
+  nlohmann::json j;
+
+#ifdef NDEBUG
+  j["build"] = "release";
+#else
+  j["build"] = "debug";
+#endif
+
+#if defined(__clang__)
+  j["compiler"] = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+  j["compiler"] = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+  j["compiler"] = "msvc " + std::to_string(_MSC_VER);
+#endif
+
+  j["timestamp_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+  auto& results = j["results"];
+  results = nlohmann::json::array();
+  for(const auto& r : m_results)
+    results.push_back(r.toJSON());
+
+  return j;
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "json.hpp"
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace tp_data_benchmarks
+{
+
+//##################################################################################################
+//! The number of allocations made through the global operator new since the program started.
+size_t allocationCount();
+
+//##################################################################################################
+//! The timings of a single benchmark.
+struct Result
+{
+  std::string name;
+  size_t iterations{0};
+  size_t itemsPerOp{0}; //!< Members processed by each operation.
+  size_t bytesPerOp{0}; //!< Bytes saved or loaded by each operation, 0 if not relevant.
+
+  double minNS{0.0};
+  double meanNS{0.0};
+  double p50NS{0.0};
+  double p90NS{0.0};
+  double p99NS{0.0};
+  double allocationsPerOp{0.0};
+
+  //################################################################################################
+  double opsPerSecond() const;
+
+  //################################################################################################
+  double itemsPerSecond() const;
+
+  //################################################################################################
+  double megabytesPerSecond() const;
+
+  //################################################################################################
+  nlohmann::json toJSON() const;
+};
+
+//##################################################################################################
+//! Runs benchmarks and collects their results.
+class Harness
+{
+public:
+  //################################################################################################
+  /*!
+  \param minIterations Each benchmark is run at least this many times.
+  \param minSeconds Each benchmark is run until at least this much time has been spent in it.
+  \param filter Only benchmarks with names that contain this are run.
+  */
+  Harness(size_t minIterations, double minSeconds, const std::string& filter);
+
+  //################################################################################################
+  //! Time each call to operation, setup is called before each call but not timed.
+  void run(const std::string& name,
+           size_t itemsPerOp,
+           size_t bytesPerOp,
+           const std::function<void()>& operation,
+           const std::function<void()>& setup=std::function<void()>());
+
+  //################################################################################################
+  const std::vector<Result>& results() const;
+
+  //################################################################################################
+  //! Print a human readable table of the results.
+  void printTable(std::ostream& stream) const;
+
+  //################################################################################################
+  //! The results along with details of the build, for comparing results across commits.
+  nlohmann::json toJSON() const;
+
+private:
+  size_t m_minIterations;
+  double m_minSeconds;
+  std::string m_filter;
+  std::vector<Result> m_results;
+};
+
+}
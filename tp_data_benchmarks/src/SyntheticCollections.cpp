@@ -0,0 +1,125 @@
+#include "SyntheticCollections.h"
+
+#include "tp_data/members/NumberMember.h"
+#include "tp_data/members/NumberVectorMember.h"
+#include "tp_data/members/StringIDMember.h"
+#include "tp_data/members/StringIDVectorMember.h"
+#include "tp_data/members/StringMember.h"
+
+namespace tp_data_benchmarks
+{
+
+namespace
+{
+//##################################################################################################
+template<typename M, typename V>
+void addNumber(tp_data::Collection& collection, const std::string& name, V value)
+{
+  auto member = std::make_shared<M>(name);
+  member->data = value;
+  collection.addMember(member);
+}
+
+//##################################################################################################
+void addNumberMember(tp_data::Collection& collection, const std::string& name, size_t i)
+{
+  switch(i%4)
+  {
+  case 0: addNumber<tp_data::   IntMember>(collection, name, int(i));      break;
+  case 1: addNumber<tp_data:: SizeTMember>(collection, name, i*7919);      break;
+  case 2: addNumber<tp_data:: FloatMember>(collection, name, float(i)/3);  break;
+  case 3: addNumber<tp_data::DoubleMember>(collection, name, int(i*31));   break;
+  }
+}
+
+//##################################################################################################
+void addStringMember(tp_data::Collection& collection, const std::string& name, size_t i)
+{
+  if(i%2)
+    collection.addMember(std::make_shared<tp_data::StringMember>(name, "value of " + name));
+  else
+    collection.addMember(std::make_shared<tp_data::StringIDMember>(name, "label_" + std::to_string(i%64)));
+}
+
+//##################################################################################################
+void addVectorMember(tp_data::Collection& collection, const std::string& name, size_t i)
+{
+  if(i%2)
+  {
+    auto member = std::make_shared<tp_data::FloatVectorMember>(name);
+    member->data.resize(256);
+    for(size_t v=0; v<member->data.size(); v++)
+      member->data[v] = float(i+v)*0.25f;
+    collection.addMember(member);
+  }
+  else
+  {
+    std::vector<tp_utils::StringID> ids;
+    ids.reserve(128);
+    for(size_t v=0; v<128; v++)
+      ids.emplace_back("tag_" + std::to_string((i+v)%32));
+    collection.addMember(std::make_shared<tp_data::StringIDVectorMember>(name, ids));
+  }
+}
+}
+
+//##################################################################################################
+const std::vector<MemberMix>& allMemberMixes()
+{
+  static const std::vector<MemberMix> mixes{MemberMix::Numbers, MemberMix::Strings, MemberMix::Vectors, MemberMix::Mixed};
+  return mixes;
+}
+
+//##################################################################################################
+std::string memberMixToString(MemberMix mix)
+{
+  switch(mix)
+  {
+  case MemberMix::Numbers: return "numbers";
+  case MemberMix::Strings: return "strings";
+  case MemberMix::Vectors: return "vectors";
+  case MemberMix::Mixed:   return "mixed";
+  }
+  return "unknown";
+}
+
+//##################################################################################################
+void makeCollection(tp_data::Collection& collection, size_t memberCount, MemberMix mix)
+{
+  collection.clear();
+  collection.setName("benchmark_" + memberMixToString(mix) + "_" + std::to_string(memberCount));
+  collection.setTimestampMS(1600000000000);
+
+  for(size_t i=0; i<memberCount; i++)
+  {
+    std::string name = "member_" + std::to_string(i);
+
+    MemberMix m = mix;
+    if(m == MemberMix::Mixed)
+    {
+      //Mostly scalars with the occasional vector, like a typical annotation collection.
+      auto r = i%10;
+      m = (r<6)?MemberMix::Numbers:((r<9)?MemberMix::Strings:MemberMix::Vectors);
+    }
+
+    switch(m)
+    {
+    case MemberMix::Numbers: addNumberMember(collection, name, i); break;
+    case MemberMix::Strings: addStringMember(collection, name, i); break;
+    case MemberMix::Vectors: addVectorMember(collection, name, i); break;
+    case MemberMix::Mixed:                                          break;
+    }
+  }
+}
+
+//##################################################################################################
+std::vector<std::string> memberNames(const tp_data::Collection& collection, size_t stride)
+{
+  std::vector<std::string> names;
+  const auto& members = collection.members();
+  for(size_t i=0; i<members.size(); i+=std::max(stride, size_t(1)))
+    names.push_back(members.at(i)->name().toString());
+  return names;
+}
+
+}
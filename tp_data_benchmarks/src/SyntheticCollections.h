@@ -0,0 +1,35 @@
+#pragma once
+
+#include "tp_data/Collection.h"
+
+#include <string>
+#include <vector>
+
+namespace tp_data_benchmarks
+{
+
+//##################################################################################################
+//! The types of member that a synthetic collection is made of.
+enum class MemberMix
+{
+  Numbers, //!< Int, SizeT, Float and Double members.
+  Strings, //!< String and StringID members.
+  Vectors, //!< Float vectors and string id vectors of a few hundred values.
+  Mixed    //!< All of the above.
+};
+
+//##################################################################################################
+const std::vector<MemberMix>& allMemberMixes();
+
+//##################################################################################################
+std::string memberMixToString(MemberMix mix);
+
+//##################################################################################################
+//! Fill a collection with memberCount members, the content is deterministic.
+void makeCollection(tp_data::Collection& collection, size_t memberCount, MemberMix mix);
+
+//##################################################################################################
+//! The names of every nth member of a collection.
+std::vector<std::string> memberNames(const tp_data::Collection& collection, size_t stride=1);
+
+}
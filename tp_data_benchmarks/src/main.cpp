@@ -0,0 +1,201 @@
+#include "Harness.h"
+#include "SyntheticCollections.h"
+
+#include "tp_data/Collection.h"
+#include "tp_data/CollectionFactory.h"
+#include "tp_data/members/NumberMember.h"
+
+#include "tp_utils/FileUtils.h"
+
+#include <iostream>
+
+using namespace tp_data_benchmarks;
+
+namespace
+{
+
+//##################################################################################################
+void printUsage()
+{
+  std::cout <<
+    "Usage: tp_data_benchmarks [options]\n"
+    "  --json <file>       Write the results as JSON to file, use - for stdout.\n"
+    "  --filter <text>     Only run benchmarks with names that contain text.\n"
+    "  --tmp <directory>   Where to write collections for the path benchmarks.\n"
+    "  --quick             Run fewer iterations, for checking that the benchmarks work.\n";
+}
+
+//##################################################################################################
+void benchmarkCollection(Harness& harness,
+                         const tp_data::CollectionFactory& factory,
+                         size_t memberCount,
+                         MemberMix mix,
+                         const std::string& tmpDirectory)
+{
+  std::string prefix = memberMixToString(mix) + "/" + std::to_string(memberCount) + "/";
+
+  tp_data::Collection collection;
+  makeCollection(collection, memberCount, mix);
+
+  std::string error;
+  std::string blob;
+  factory.saveToData(error, collection, blob);
+  if(!error.empty())
+  {
+    std::cerr << "Failed to save " << prefix << ": " << error << std::endl;
+    return;
+  }
+
+  //-- saveToData ----------------------------------------------------------------------------------
+  {
+    std::string data;
+    harness.run(prefix + "saveToData", memberCount, blob.size(), [&]
+    {
+      error.clear();
+      data.clear();
+      factory.saveToData(error, collection, data);
+    });
+  }
+
+  //-- loadFromData --------------------------------------------------------------------------------
+  {
+    tp_data::Collection output;
+    harness.run(prefix + "loadFromData", memberCount, blob.size(), [&]
+    {
+      error.clear();
+      factory.loadFromData(error, blob, output);
+    }, [&]{output.clear();});
+  }
+
+  //-- loadFromData with a subset of 1 in 10 members -----------------------------------------------
+  {
+    auto subset = memberNames(collection, 10);
+    tp_data::Collection output;
+    harness.run(prefix + "loadFromData/subset", subset.size(), blob.size(), [&]
+    {
+      error.clear();
+      factory.loadFromData(error, blob, output, subset);
+    }, [&]{output.clear();});
+  }
+
+  //-- cloneAppend ---------------------------------------------------------------------------------
+  {
+    tp_data::Collection output;
+    harness.run(prefix + "cloneAppend", memberCount, 0, [&]
+    {
+      error.clear();
+      factory.cloneAppend(error, collection, output);
+    }, [&]{output.clear();});
+  }
+
+  //-- Collection::member --------------------------------------------------------------------------
+  {
+    auto names = memberNames(collection);
+    std::vector<tp_utils::StringID> ids(names.begin(), names.end());
+    size_t found=0;
+    harness.run(prefix + "member", ids.size(), 0, [&]
+    {
+      for(const auto& id : ids)
+        found += collection.member(id)?1:0;
+    });
+  }
+
+  //-- Collection::memberCast ----------------------------------------------------------------------
+  {
+    auto names = memberNames(collection);
+    std::vector<tp_utils::StringID> ids(names.begin(), names.end());
+    size_t found=0;
+    harness.run(prefix + "memberCast", ids.size(), 0, [&]
+    {
+      for(const auto& id : ids)
+        found += collection.memberCast<tp_data::FloatMember>(id)?1:0;
+    });
+  }
+
+  //-- saveToPath and loadFromPath write a file per member so are only run on smaller collections ---
+  if(memberCount<=1024 && !tmpDirectory.empty())
+  {
+    std::string path = tmpDirectory + "/" + memberMixToString(mix) + "_" + std::to_string(memberCount);
+    tp_utils::rm(path, TPRecursive::Yes);
+
+    harness.run(prefix + "saveToPath", memberCount, blob.size(), [&]
+    {
+      error.clear();
+      factory.saveToPath(error, collection, path, false);
+    }, [&]{tp_utils::rm(path, TPRecursive::Yes);});
+
+    tp_utils::rm(path, TPRecursive::Yes);
+    factory.saveToPath(error, collection, path, false);
+    tp_data::Collection output;
+    harness.run(prefix + "loadFromPath", memberCount, blob.size(), [&]
+    {
+      error.clear();
+      factory.loadFromPath(error, path, output);
+    }, [&]{output.clear();});
+
+    tp_utils::rm(path, TPRecursive::Yes);
+  }
+
+  if(!error.empty())
+    std::cerr << "Error in " << prefix << ": " << error << std::endl;
+}
+
+}
+
+//##################################################################################################
+int main(int argc, const char** argv)
+{
+  std::string jsonPath;
+  std::string filter;
+  std::string tmpDirectory = "tp_data_benchmarks_tmp";
+  bool quick=false;
+
+  for(int a=1; a<argc; a++)
+  {
+    std::string arg = argv[a];
+    auto value = [&]{return (a+1<argc)?std::string(argv[++a]):std::string();};
+
+    if(arg == "--json")
+      jsonPath = value();
+    else if(arg == "--filter")
+      filter = value();
+    else if(arg == "--tmp")
+      tmpDirectory = value();
+    else if(arg == "--quick")
+      quick = true;
+    else
+    {
+      printUsage();
+      return (arg=="--help" || arg=="-h")?0:1;
+    }
+  }
+
+  tp_data::CollectionFactory factory;
+  tp_data::createCollectionFactories(factory);
+  factory.finalize();
+
+  //Only remove the temporary directory at the end if it was created here.
+  bool createdTmpDirectory=false;
+  if(!tmpDirectory.empty() && !tp_utils::exists(tmpDirectory))
+    createdTmpDirectory = tp_utils::mkdir(tmpDirectory, TPCreateFullPath::Yes);
+
+  Harness harness(quick?3:20, quick?0.0:0.25, filter);
+
+  for(auto memberCount : {size_t(16), size_t(1024), size_t(16384)})
+    for(auto mix : allMemberMixes())
+      benchmarkCollection(harness, factory, memberCount, mix, tmpDirectory);
+
+  if(createdTmpDirectory)
+    tp_utils::rm(tmpDirectory, TPRecursive::Yes);
+
+  if(jsonPath == "-")
+    std::cout << harness.toJSON().dump(2) << std::endl;
+  else
+  {
+    harness.printTable(std::cout);
+    if(!jsonPath.empty())
+      tp_utils::writePrettyJSONFile(jsonPath, harness.toJSON());
+  }
+
+  return 0;
+}
@@ -0,0 +1,10 @@
+TARGET = tp_data_benchmarks
+TEMPLATE = app
+
+SOURCES += src/main.cpp
+
+SOURCES += src/Harness.cpp
+HEADERS += src/Harness.h
+
+SOURCES += src/SyntheticCollections.cpp
+HEADERS += src/SyntheticCollections.h
@@ -3,6 +3,9 @@ TEMPLATE = lib
 
 DEFINES += tp_qt_DATA_LIBRARY
 
+#Uncomment to record trace events for load and save operations, see tp_data/Tracing.h
+#DEFINES += TP_DATA_ENABLE_TRACING
+
 SOURCES += src/Globals.cpp
 HEADERS += inc/tp_data/Globals.h
 
@@ -14,9 +17,55 @@ HEADERS += inc/tp_data/AbstractMemberFactory.h
 
 SOURCES += src/Collection.cpp
 HEADERS += inc/tp_data/Collection.h
+HEADERS += inc/tp_data/MemoryUsage.h
+HEADERS += inc/tp_data/TypedCollection.h
+HEADERS += inc/tp_data/Reflect.h
 
 SOURCES += src/CollectionFactory.cpp
 HEADERS += inc/tp_data/CollectionFactory.h
+HEADERS += inc/tp_data/BlobFormat.h
+
+SOURCES += src/BinaryDelta.cpp
+HEADERS += inc/tp_data/BinaryDelta.h
+
+SOURCES += src/ContentHash.cpp
+HEADERS += inc/tp_data/ContentHash.h
+
+SOURCES += src/CollectionDiff.cpp
+HEADERS += inc/tp_data/CollectionDiff.h
+
+SOURCES += src/CollectionInfo.cpp
+HEADERS += inc/tp_data/CollectionInfo.h
+
+SOURCES += src/LoadFilter.cpp
+HEADERS += inc/tp_data/LoadFilter.h
+
+SOURCES += src/Executor.cpp
+HEADERS += inc/tp_data/Executor.h
+
+SOURCES += src/CollectionCache.cpp
+HEADERS += inc/tp_data/CollectionCache.h
+
+SOURCES += src/DatasetIndex.cpp
+HEADERS += inc/tp_data/DatasetIndex.h
+
+SOURCES += src/FactoryCounters.cpp
+HEADERS += inc/tp_data/FactoryCounters.h
+
+SOURCES += src/Tracing.cpp
+HEADERS += inc/tp_data/Tracing.h
+
+SOURCES += src/CollectionBatch.cpp
+HEADERS += inc/tp_data/CollectionBatch.h
+
+HEADERS += inc/tp_data/AlignedAllocator.h
+HEADERS += inc/tp_data/BinaryUtils.h
+
+SOURCES += src/SharedBuffer.cpp
+HEADERS += inc/tp_data/SharedBuffer.h
+
+SOURCES += src/VectorKernels.cpp
+HEADERS += inc/tp_data/VectorKernels.h
 
 #-- Members ----------------------------------------------------------------------------------------
 SOURCES += src/members/StringMember.cpp
@@ -31,4 +80,16 @@ HEADERS += inc/tp_data/members/NumberMember.h
 SOURCES += src/members/StringIDVectorMember.cpp
 HEADERS += inc/tp_data/members/StringIDVectorMember.h
 
+SOURCES += src/members/NumberVectorMember.cpp
+HEADERS += inc/tp_data/members/NumberVectorMember.h
+
+SOURCES += src/members/TensorMember.cpp
+HEADERS += inc/tp_data/members/TensorMember.h
+
+SOURCES += src/members/ImageMember.cpp
+HEADERS += inc/tp_data/members/ImageMember.h
+
+SOURCES += src/members/BytesMember.cpp
+HEADERS += inc/tp_data/members/BytesMember.h
+
 HEADERS += inc/tp_data/members/MemberUtils.h